@@ -0,0 +1,131 @@
+/**
+ * @file bench_proc_reader.cpp
+ * @brief Benchmark: batched /proc reads for 1,000 processes
+ *
+ * Reads comm, stat, statm and cgroup for 1,000 PIDs (spawning idle children
+ * if the system has fewer processes) once with plain open/read/close and
+ * once through io_uring, and reports syscalls and latency per refresh.
+ * No X server is needed.
+ */
+
+#include "ProcBatchReader.h"
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <dirent.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace CrossWindow;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    constexpr size_t kPidCount = 1000;
+    constexpr int kRounds = 20;
+
+    std::vector<uint32_t> ListPids()
+    {
+        std::vector<uint32_t> pids;
+        DIR *dir = opendir("/proc");
+        if (!dir)
+            return pids;
+        while (dirent *entry = readdir(dir))
+        {
+            char *end = nullptr;
+            unsigned long pid = std::strtoul(entry->d_name, &end, 10);
+            if (pid > 0 && *end == '\0')
+                pids.push_back(static_cast<uint32_t>(pid));
+        }
+        closedir(dir);
+        return pids;
+    }
+
+    struct Result
+    {
+        double medianMs = 0;
+        size_t syscalls = 0;
+        size_t filesRead = 0;
+    };
+
+    Result Measure(Proc::BatchReader &reader, const std::vector<uint32_t> &pids)
+    {
+        static const char *const kFiles[] = {"comm", "stat", "statm", "cgroup"};
+        std::vector<std::string> texts(pids.size() * 4);
+        std::vector<Proc::ReadRequest> requests(texts.size());
+        for (size_t i = 0; i < pids.size(); ++i)
+            for (size_t f = 0; f < 4; ++f)
+                requests[i * 4 + f] = {pids[i], kFiles[f], &texts[i * 4 + f]};
+
+        Result result;
+        std::vector<double> times;
+        for (int round = 0; round < kRounds; ++round)
+        {
+            reader.ResetSyscallCount();
+            auto start = Clock::now();
+            reader.Read(requests);
+            times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            result.syscalls = reader.GetSyscallCount();
+        }
+        std::sort(times.begin(), times.end());
+        result.medianMs = times[times.size() / 2];
+        result.filesRead = static_cast<size_t>(std::count_if(requests.begin(), requests.end(),
+                                                             [](const Proc::ReadRequest &r)
+                                                             { return r.ok; }));
+        return result;
+    }
+} // namespace
+
+int main()
+{
+    std::vector<uint32_t> pids = ListPids();
+    std::vector<pid_t> children;
+    if (pids.size() < kPidCount)
+    {
+        std::cout << "Spawning " << kPidCount - pids.size() << " idle processes...\n";
+        while (pids.size() + children.size() < kPidCount)
+        {
+            pid_t child = fork();
+            if (child == 0)
+            {
+                pause();
+                _exit(0);
+            }
+            if (child < 0)
+                break;
+            children.push_back(child);
+        }
+        pids = ListPids();
+    }
+    pids.resize(std::min(pids.size(), kPidCount));
+
+    Proc::BatchReader uring;
+    Proc::BatchReader plain;
+    plain.DisableIoUring();
+
+    Result plainResult = Measure(plain, pids);
+    std::cout << "PIDs: " << pids.size() << ", files per refresh: " << pids.size() * 4 << "\n";
+    std::cout << "open/read/close: " << plainResult.medianMs << " ms, " << plainResult.syscalls
+              << " syscalls (" << plainResult.filesRead << " files read)\n";
+
+    if (uring.IsUsingIoUring())
+    {
+        Result uringResult = Measure(uring, pids);
+        std::cout << "io_uring:        " << uringResult.medianMs << " ms, " << uringResult.syscalls
+                  << " syscalls (" << uringResult.filesRead << " files read)\n";
+    }
+    else
+    {
+        std::cout << "io_uring:        unavailable (not compiled in, or refused by the kernel)\n";
+    }
+
+    for (pid_t child : children)
+        kill(child, SIGKILL);
+    for (pid_t child : children)
+        waitpid(child, nullptr, 0);
+    return 0;
+}
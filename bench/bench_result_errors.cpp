@@ -0,0 +1,137 @@
+/**
+ * @file bench_result_errors.cpp
+ * @brief Benchmark: allocations and latency of failing calls
+ *
+ * Runs a validity sweep against a WindowManager that was never initialized,
+ * so every call fails with NotInitialized, and compares building failed
+ * Results with the old std::string message against ErrorMessage. Heap
+ * allocations are counted by replacing the global operator new.
+ * No X server is needed.
+ */
+
+#include "CrossWindow.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+using namespace CrossWindow;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    std::atomic<size_t> g_allocations{0};
+
+    constexpr int kCalls = 1000000;
+
+    // Result as it was before ErrorMessage, for comparison
+    template <typename T>
+    struct StringResult
+    {
+        T value;
+        ErrorCode error = ErrorCode::Success;
+        std::string errorMessage;
+    };
+
+    struct Measurement
+    {
+        double nsPerCall = 0;
+        double allocationsPerCall = 0;
+    };
+
+    template <typename Function>
+    Measurement Measure(Function &&function)
+    {
+        size_t before = g_allocations.load();
+        auto start = Clock::now();
+        for (int i = 0; i < kCalls; ++i)
+        {
+            function(i);
+        }
+        Measurement m;
+        m.nsPerCall = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kCalls;
+        m.allocationsPerCall = static_cast<double>(g_allocations.load() - before) / kCalls;
+        return m;
+    }
+
+    void Report(const char *name, const Measurement &m)
+    {
+        std::cout << "  " << name << ": " << m.nsPerCall << " ns/call, " << m.allocationsPerCall
+                  << " allocations/call\n";
+    }
+
+    template <typename R>
+    R Fail(int i)
+    {
+        R result;
+        if (i & 1)
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+        }
+        else
+        {
+            result.error = ErrorCode::NotInitialized;
+            result.errorMessage = "WindowManager not initialized"_msg;
+        }
+        return result;
+    }
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    std::cout << "Failing Results (" << kCalls << " each):\n";
+    volatile size_t sink = 0;
+
+    auto failString = [&](int i)
+    { sink = sink + Fail<StringResult<Rect>>(i).errorMessage.size(); };
+    auto failMessage = [&](int i)
+    { sink = sink + Fail<Result<Rect>>(i).errorMessage.size(); };
+    Report("std::string message", Measure(failString));
+    Report("ErrorMessage       ", Measure(failMessage));
+
+    std::cout << "Successful Results:\n";
+    auto succeedString = [&](int i)
+    {
+        StringResult<int> result;
+        result.value = i;
+        sink = sink + result.value;
+    };
+    auto succeedMessage = [&](int i)
+    {
+        Result<int> result;
+        result.value = i;
+        sink = sink + result.value;
+    };
+    Report("std::string message", Measure(succeedString));
+    Report("ErrorMessage       ", Measure(succeedMessage));
+
+    std::cout << "Validity sweep on an uninitialized WindowManager:\n";
+    WindowManager wm;
+    auto sweepCall = [&](int)
+    { sink = sink + wm.GetWindowRect(NativeHandle{}).errorMessage.size(); };
+    Measurement sweep = Measure(sweepCall);
+    Report("GetWindowRect      ", sweep);
+
+    return sweep.allocationsPerCall == 0 ? 0 : 1;
+}
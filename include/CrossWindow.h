@@ -9,10 +9,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iosfwd>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // Platform detection and export macros
@@ -93,6 +100,66 @@ namespace CrossWindow
         return (static_cast<uint32_t>(state) & static_cast<uint32_t>(flag)) != 0;
     }
 
+    /**
+     * @brief EWMH window type (_NET_WM_WINDOW_TYPE), usable as a set of flags
+     */
+    enum class WindowType : uint32_t
+    {
+        Normal = 1 << 0,
+        Desktop = 1 << 1,
+        Dock = 1 << 2,
+        Toolbar = 1 << 3,
+        Menu = 1 << 4,
+        Utility = 1 << 5,
+        Splash = 1 << 6,
+        Dialog = 1 << 7,
+        DropdownMenu = 1 << 8,
+        PopupMenu = 1 << 9,
+        Tooltip = 1 << 10,
+        Notification = 1 << 11,
+        Combo = 1 << 12,
+        Dnd = 1 << 13
+    };
+
+    inline WindowType operator|(WindowType a, WindowType b)
+    {
+        return static_cast<WindowType>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    inline bool HasFlag(WindowType types, WindowType flag)
+    {
+        return (static_cast<uint32_t>(types) & static_cast<uint32_t>(flag)) != 0;
+    }
+
+    /**
+     * @brief Id of a string in the StringPool; 0 is the empty string
+     */
+    using StringId = uint32_t;
+
+    /**
+     * @brief Process-wide pool of class and process names
+     *
+     * The same text always gets the same id, from any thread and any
+     * WindowManager, so names can be grouped and compared as integers.
+     * Strings are never released: ids and views stay valid for the lifetime
+     * of the process, and the pool only grows with the number of distinct names.
+     */
+    class CROSSWINDOW_API StringPool
+    {
+    public:
+        static StringId Intern(std::string_view value);
+
+        /**
+         * @brief Text of an id; an unknown id gives an empty view
+         */
+        static std::string_view View(StringId id);
+
+        /**
+         * @brief Number of distinct strings interned so far, including the empty string
+         */
+        static size_t Size();
+    };
+
     /**
      * @brief Information about a window
      */
@@ -103,9 +170,200 @@ namespace CrossWindow
         std::string className; ///< Window class name (Windows) or app name
         Rect rect;             ///< Window position and size
         WindowState state = WindowState::Normal;
-        uint32_t processId = 0;  ///< Process ID that owns this window
-        std::string processName; ///< Name of the process
-        bool isVisible = false;  ///< Whether window is visible
+        uint32_t processId = 0;      ///< Process ID that owns this window
+        std::string processName;     ///< Name of the process
+        bool isVisible = false;      ///< Whether window is visible
+        bool titleTruncated = false; ///< Title was cut off at PropertyLimits::maxTitleBytes
+        std::string cgroupPath;      ///< Linux: cgroup of the process (when requested)
+        std::string cgroupUnit;      ///< Linux: innermost systemd .service/.scope unit
+        std::string containerId;     ///< Linux: container id found in the cgroup path
+        int desktop = -1;            ///< Virtual desktop index; -1 if on all desktops or unknown
+        WindowType type = WindowType::Normal; ///< Linux: EWMH window type
+        bool skipTaskbar = false;    ///< Linux: asks not to be shown in taskbars
+        bool skipPager = false;      ///< Linux: asks not to be shown in pagers
+        int monitor = -1;            ///< Index into GetMonitors() of the monitor showing most of the window; -1 if none
+        uint64_t generation = 0;     ///< Linux: with handle, forms a WindowId; 0 if not tracked
+        StringId classNameId = 0;    ///< className in the StringPool
+        StringId processNameId = 0;  ///< processName in the StringPool
+    };
+
+    /**
+     * @brief A window handle that cannot silently refer to a later window
+     *
+     * Native handles can be reused once a window is gone (X window ids are).
+     * The generation is assigned by the WindowManager that first saw the
+     * window, so an id is only meaningful to that manager.
+     */
+    struct WindowId
+    {
+        NativeHandle handle{};
+        uint64_t generation = 0; ///< 0 accepts whichever window has the handle now
+
+        bool operator==(const WindowId &other) const
+        {
+            return handle == other.handle && generation == other.generation;
+        }
+        bool operator!=(const WindowId &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief WindowInfo fields, as a set of flags reporting what changed
+     */
+    enum class WindowField : uint32_t
+    {
+        None = 0,
+        Title = 1 << 0,      ///< title, titleTruncated
+        ClassName = 1 << 1,
+        Rect = 1 << 2,
+        State = 1 << 3,
+        Process = 1 << 4,    ///< processId, processName
+        Visibility = 1 << 5, ///< isVisible
+        Desktop = 1 << 6,
+        Type = 1 << 7,       ///< type, skipTaskbar, skipPager
+        Monitor = 1 << 8,
+        Cgroup = 1 << 9,     ///< cgroupPath, cgroupUnit, containerId
+        All = (1 << 10) - 1
+    };
+
+    inline WindowField operator|(WindowField a, WindowField b)
+    {
+        return static_cast<WindowField>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    inline bool HasFlag(WindowField fields, WindowField flag)
+    {
+        return (static_cast<uint32_t>(fields) & static_cast<uint32_t>(flag)) != 0;
+    }
+
+    /**
+     * @brief One window that appeared, disappeared or changed between two generations
+     */
+    struct WindowChange
+    {
+        enum class Kind
+        {
+            Added,
+            Removed,
+            Modified
+        };
+
+        Kind kind = Kind::Added;
+        WindowField fields = WindowField::None; ///< Modified: the fields that differ; Added: All
+        WindowInfo window;                      ///< Current state; only handle is set for Removed
+    };
+
+    /**
+     * @brief Result of WindowManager::GetChangesSince
+     */
+    struct WindowChanges
+    {
+        uint64_t generation = 0;          ///< Pass to the next GetChangesSince
+        bool fullSnapshot = false;        ///< The log no longer reached back; snapshot replaces everything
+        std::vector<WindowChange> changes; ///< In the order they happened, one entry per window
+        std::vector<WindowInfo> snapshot;  ///< Every window, when fullSnapshot is set
+    };
+
+    /**
+     * @brief Windows stored column by column, for scans over many windows
+     *
+     * Row i of every column belongs to the same window. Numeric fields sit in
+     * contiguous arrays and all strings share one buffer, so a filter over
+     * states or rectangles only reads the columns it needs. Filters return the
+     * matching row indices in table order.
+     */
+    class CROSSWINDOW_API WindowTable
+    {
+    public:
+        /// A string in the shared buffer
+        struct StringRef
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        std::vector<NativeHandle> handles;
+        std::vector<int> x;
+        std::vector<int> y;
+        std::vector<int> width;
+        std::vector<int> height;
+        std::vector<WindowState> states;
+        std::vector<WindowType> types;
+        std::vector<uint32_t> processIds;
+        std::vector<int> desktops;
+        std::vector<int> monitors;
+        std::vector<uint64_t> generations;
+        std::vector<StringId> classNameIds;
+        std::vector<StringId> processNameIds;
+        std::vector<uint8_t> visible;        ///< 1 if WindowInfo::isVisible
+        std::vector<uint8_t> titleTruncated;
+        std::vector<uint8_t> skipTaskbar;
+        std::vector<uint8_t> skipPager;
+        std::vector<StringRef> titles;
+        std::vector<StringRef> classNames;
+        std::vector<StringRef> processNames;
+        std::vector<StringRef> cgroupPaths;
+        std::vector<StringRef> cgroupUnits;
+        std::vector<StringRef> containerIds;
+        std::string strings; ///< Backing buffer of every StringRef
+
+        size_t size() const { return handles.size(); }
+        bool empty() const { return handles.empty(); }
+
+        void reserve(size_t rows);
+        void clear();
+
+        /**
+         * @brief Add a window as the last row
+         */
+        void Append(const WindowInfo &info);
+
+        /**
+         * @brief Copy a row back out as a WindowInfo
+         */
+        WindowInfo Row(size_t row) const;
+
+        std::string_view String(StringRef ref) const { return std::string_view(strings).substr(ref.offset, ref.length); }
+        std::string_view Title(size_t row) const { return String(titles[row]); }
+        std::string_view ClassName(size_t row) const { return String(classNames[row]); }
+        std::string_view ProcessName(size_t row) const { return String(processNames[row]); }
+
+        /**
+         * @brief Rows whose state has every flag in flags set
+         */
+        std::vector<uint32_t> WithState(WindowState flags) const;
+
+        /**
+         * @brief Rows whose state has none of the flags set
+         */
+        std::vector<uint32_t> WithoutState(WindowState flags) const;
+
+        /**
+         * @brief Rows whose rectangle overlaps area; empty rectangles overlap nothing
+         */
+        std::vector<uint32_t> Intersecting(const Rect &area) const;
+
+        /**
+         * @brief Rows that are visible
+         */
+        std::vector<uint32_t> Visible() const;
+
+    private:
+        StringRef Intern(const std::string &value);
+    };
+
+    /**
+     * @brief Upper bounds on how much of a window property is downloaded
+     *
+     * Protects enumeration from clients that publish huge titles or state lists.
+     * Longer properties are cut off at the limit.
+     */
+    struct PropertyLimits
+    {
+        uint32_t maxTitleBytes = 4096;            ///< _NET_WM_NAME / WM_NAME
+        uint32_t maxClassBytes = 1024;            ///< WM_CLASS
+        uint32_t maxStateAtoms = 64;              ///< Entries of _NET_WM_STATE
+        uint32_t maxClientListWindows = 1u << 16; ///< Entries of _NET_CLIENT_LIST; more mark the enumeration partial
+        uint32_t maxPropertyBytes = 1u << 16;     ///< Any property read through GetWindowProperty
     };
 
     /**
@@ -119,9 +377,188 @@ namespace CrossWindow
         WindowNotFound,
         OperationFailed,
         NotSupported,
-        NotInitialized
+        NotInitialized,
+        Timeout,
+        NotConnected ///< The connection to the display server was lost; a reconnect is pending
+    };
+
+    /**
+     * @brief Point in time after which a query stops waiting for the display server
+     */
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    /// Deadline that never expires
+    constexpr Deadline NoDeadline = Deadline::max();
+
+    /**
+     * @brief How the last enumeration discovered top-level windows
+     */
+    enum class EnumerationStrategy
+    {
+        Native = 0, ///< Platform window list (EnumWindows, CGWindowListCopyWindowInfo)
+        ClientList, ///< EWMH _NET_CLIENT_LIST published by the window manager
+        TreeWalk    ///< Walk of the X window tree from the root (no EWMH window manager)
+    };
+
+    /// EnumerationOptions::desktop value that disables desktop filtering
+    constexpr int AnyDesktop = -1;
+
+    /// EnumerationOptions::desktop value selecting whichever desktop is active
+    constexpr int CurrentDesktop = -2;
+
+    /**
+     * @brief Options controlling how windows are enumerated
+     */
+    struct EnumerationOptions
+    {
+        /// Number of parallel workers fetching window details. On Linux each extra
+        /// worker runs on its own thread and X connection; the connections are opened
+        /// on first use and kept until Shutdown. Other platforms ignore it.
+        unsigned int workerCount = 1;
+
+        /// Number of windows with requests in flight while EnumerateWindows streams
+        /// results (Linux). Larger values hide more latency; smaller values waste
+        /// less work when the callback stops early.
+        unsigned int windowAhead = 32;
+
+        /// Windows per call of an EnumerateWindowBatches callback
+        unsigned int batchSize = 64;
+
+        /// Stop waiting for the display server at this point and return the windows
+        /// completed so far; WasLastEnumerationPartial() then reports true (Linux)
+        Deadline deadline = NoDeadline;
+
+        /// Fill cgroupPath, cgroupUnit and containerId (Linux). Cgroups are cached
+        /// per process, so only processes not seen before cost a /proc read.
+        bool includeCgroup = false;
+
+        /// Only return windows on this virtual desktop (Linux). Windows shown on all
+        /// desktops always match. Windows elsewhere are rejected after a single
+        /// property read, before anything else about them is fetched.
+        int desktop = AnyDesktop;
+
+        /// Window types to leave out, e.g. WindowType::Dock | WindowType::Tooltip (Linux).
+        /// Like the desktop filter, this is decided from a small property read before
+        /// the full fetch.
+        WindowType excludeTypes{};
+
+        /// Leave out windows that ask not to appear in taskbars or pagers (Linux)
+        bool excludeSkipTaskbar = false;
+        bool excludeSkipPager = false;
+    };
+
+    /**
+     * @brief CPU and memory use of a process, as of one sample
+     */
+    struct ResourceUsage
+    {
+        uint32_t processId = 0;
+        uint64_t residentBytes = 0; ///< Resident set size
+        uint64_t cpuTimeMs = 0;     ///< User + system CPU time since the process started
+        double cpuPercent = -1.0;   ///< CPU use since the previous sample (100 = one core); -1 on the first sample
+        std::chrono::steady_clock::time_point sampledAt;
+    };
+
+    /**
+     * @brief Windows of one application, across all of its processes
+     */
+    struct ApplicationGroup
+    {
+        uint32_t rootProcessId = 0;      ///< Topmost process of the application
+        std::string rootProcessName;     ///< Name of the root process
+        std::vector<WindowInfo> windows; ///< Windows owned by the root or its children
+    };
+
+    /**
+     * @brief A window together with the resource use of its process
+     */
+    struct WindowResourceUsage
+    {
+        WindowInfo window;
+        ResourceUsage usage;
+    };
+
+    /**
+     * @brief A monitor (logical output) and its place in the desktop
+     */
+    struct MonitorInfo
+    {
+        std::string name;       ///< Output name, e.g. "DP-1"
+        Rect rect;              ///< Position and size within the desktop, in pixels
+        bool primary = false;   ///< The monitor marked as primary
+        uint32_t widthMm = 0;   ///< Physical width; 0 if unknown
+        uint32_t heightMm = 0;  ///< Physical height; 0 if unknown
+        double dpi = 96.0;      ///< Horizontal density derived from the physical size
+        double scaleHint = 1.0; ///< dpi / 96 rounded to a quarter; a hint, not a toolkit setting
+    };
+
+    class ErrorMessage;
+
+    inline namespace literals
+    {
+        /// A fixed error message, pointed to rather than copied: "Window not found"_msg
+        ErrorMessage operator""_msg(const char *text, size_t length) noexcept;
+    } // namespace literals
+
+    /**
+     * @brief Text of a Result error that costs nothing unless it is formatted
+     *
+     * Fixed messages are string literals written with the _msg suffix and are
+     * only pointed to; a formatted message, or any other C string or array, is
+     * copied once into a shared buffer. Constructing, copying and destroying an
+     * empty or fixed message never allocates.
+     */
+    class ErrorMessage
+    {
+    public:
+        ErrorMessage() noexcept = default;
+
+        /// A C string or char array may not outlive the message, so it is copied;
+        /// use the _msg literal to keep a fixed message by reference
+        ErrorMessage(const char *text) : ErrorMessage(text ? std::string(text) : std::string()) {}
+
+        ErrorMessage(std::string text)
+            : m_formatted(text.empty() ? nullptr : std::make_shared<const std::string>(std::move(text)))
+        {
+        }
+
+        std::string_view view() const noexcept { return m_formatted ? std::string_view(*m_formatted) : m_fixed; }
+        const char *c_str() const noexcept { return m_formatted ? m_formatted->c_str() : m_fixed.data(); }
+        bool empty() const noexcept { return view().empty(); }
+        size_t size() const noexcept { return view().size(); }
+
+        operator std::string() const { return std::string(view()); }
+
+        friend bool operator==(const ErrorMessage &a, std::string_view b) noexcept { return a.view() == b; }
+        friend bool operator==(std::string_view a, const ErrorMessage &b) noexcept { return a == b.view(); }
+        friend bool operator!=(const ErrorMessage &a, std::string_view b) noexcept { return a.view() != b; }
+        friend bool operator!=(std::string_view a, const ErrorMessage &b) noexcept { return a != b.view(); }
+
+        template <typename CharT, typename Traits>
+        friend std::basic_ostream<CharT, Traits> &operator<<(std::basic_ostream<CharT, Traits> &stream,
+                                                             const ErrorMessage &message)
+        {
+            return stream << message.view();
+        }
+
+    private:
+        friend ErrorMessage literals::operator""_msg(const char *text, size_t length) noexcept;
+
+        explicit ErrorMessage(std::string_view literal) noexcept : m_fixed(literal) {}
+
+        std::string_view m_fixed = ""; ///< Null-terminated: a literal or ""
+        std::shared_ptr<const std::string> m_formatted;
     };
 
+    inline namespace literals
+    {
+        inline ErrorMessage operator""_msg(const char *text, size_t length) noexcept
+        {
+            // Only a string literal can reach a literal operator, so the view stays valid
+            return ErrorMessage(std::string_view(text, length));
+        }
+    } // namespace literals
+
     /**
      * @brief Result type for operations that can fail
      */
@@ -130,18 +567,197 @@ namespace CrossWindow
     {
         T value;
         ErrorCode error = ErrorCode::Success;
-        std::string errorMessage;
+        ErrorMessage errorMessage;
 
         bool ok() const { return error == ErrorCode::Success; }
         operator bool() const { return ok(); }
     };
 
+    /**
+     * @brief Raw value of a window property
+     */
+    struct WindowProperty
+    {
+        std::string type;          ///< Name of the property type, e.g. "UTF8_STRING" or "CARDINAL"
+        int format = 0;            ///< Bits per item (8, 16 or 32); 0 if the property is not set
+        std::vector<uint8_t> data; ///< Items in host byte order, format / 8 bytes each
+        bool truncated = false;    ///< Cut off at PropertyLimits::maxPropertyBytes
+
+        bool exists() const { return format != 0; }
+        size_t count() const { return format ? data.size() / (format / 8) : 0; }
+    };
+
+    /**
+     * @brief Converts a WindowProperty for WindowManager::GetProperty<T>
+     *
+     * Specialise Decode for other types. Values of type ATOM are server atom ids.
+     * @return false if the property does not have the expected format
+     */
+    template <typename T>
+    struct PropertyDecoder;
+
+    /// Text of a format-8 property, up to the first NUL
+    template <>
+    struct PropertyDecoder<std::string>
+    {
+        static bool Decode(const WindowProperty &property, std::string &out)
+        {
+            if (property.format != 8)
+            {
+                return false;
+            }
+            out.assign(property.data.begin(), property.data.end());
+            out.resize(std::min(out.size(), out.find('\0')));
+            return true;
+        }
+    };
+
+    /// NUL-separated strings of a format-8 property, such as WM_CLASS
+    template <>
+    struct PropertyDecoder<std::vector<std::string>>
+    {
+        static bool Decode(const WindowProperty &property, std::vector<std::string> &out)
+        {
+            if (property.format != 8)
+            {
+                return false;
+            }
+            out.clear();
+            std::string item;
+            for (uint8_t c : property.data)
+            {
+                if (c == 0)
+                {
+                    out.push_back(std::move(item));
+                    item.clear();
+                }
+                else
+                {
+                    item.push_back(static_cast<char>(c));
+                }
+            }
+            if (!item.empty())
+            {
+                out.push_back(std::move(item));
+            }
+            return true;
+        }
+    };
+
+    /// First item of a format-32 property (CARDINAL, WINDOW, ATOM)
+    template <>
+    struct PropertyDecoder<uint32_t>
+    {
+        static bool Decode(const WindowProperty &property, uint32_t &out)
+        {
+            if (property.format != 32 || property.data.size() < sizeof(uint32_t))
+            {
+                return false;
+            }
+            std::memcpy(&out, property.data.data(), sizeof(uint32_t));
+            return true;
+        }
+    };
+
+    /// Every item of a format-32 property
+    template <>
+    struct PropertyDecoder<std::vector<uint32_t>>
+    {
+        static bool Decode(const WindowProperty &property, std::vector<uint32_t> &out)
+        {
+            if (property.format != 32)
+            {
+                return false;
+            }
+            out.resize(property.count());
+            std::memcpy(out.data(), property.data.data(), out.size() * sizeof(uint32_t));
+            return true;
+        }
+    };
+
+    /**
+     * @brief Called with the window and atom name of a watched property that changed
+     */
+    using PropertyChangeCallback = std::function<void(NativeHandle handle, const std::string &atomName)>;
+
+    /**
+     * @brief A display connection owned by the host application
+     *
+     * Lets the library run on a connection the application already has, with
+     * no second socket and no event selections of its own beyond what it needs.
+     */
+    struct ExternalConnection
+    {
+        void *display = nullptr;       ///< Linux: Xlib Display* (required)
+        void *xcbConnection = nullptr; ///< Linux: xcb_connection_t*; taken from the Display when null
+        bool takeOwnership = false;    ///< Close the connection on Shutdown
+        /// Add PropertyChange on the root and RandR change notifications to this
+        /// client's selections. Clear it if the host already selects them.
+        bool selectEvents = true;
+    };
+
+    template <typename Signature>
+    class FunctionRef;
+
+    /**
+     * @brief Non-owning reference to a callable
+     *
+     * Calls through one function pointer and never allocates, unlike
+     * std::function. It does not keep the callable alive, which is fine for
+     * a lambda written directly in the argument list of a call.
+     */
+    template <typename R, typename... Args>
+    class FunctionRef<R(Args...)>
+    {
+    public:
+        template <typename F,
+                  typename = std::enable_if_t<!std::is_same<std::decay_t<F>, FunctionRef>::value &&
+                                              !std::is_function<std::remove_reference_t<F>>::value &&
+                                              std::is_invocable_r<R, F &, Args...>::value>>
+        FunctionRef(F &&callable) noexcept
+            : m_call([](const Target &target, Args... args) -> R
+                     { return (*static_cast<std::remove_reference_t<F> *>(target.object))(std::forward<Args>(args)...); })
+        {
+            m_target.object = const_cast<void *>(static_cast<const void *>(std::addressof(callable)));
+        }
+
+        FunctionRef(R (*function)(Args...)) noexcept
+            : m_call([](const Target &target, Args... args) -> R
+                     { return target.function(std::forward<Args>(args)...); })
+        {
+            m_target.function = function;
+        }
+
+        R operator()(Args... args) const { return m_call(m_target, std::forward<Args>(args)...); }
+
+    private:
+        union Target
+        {
+            void *object;
+            R (*function)(Args...);
+        };
+
+        Target m_target;
+        R (*m_call)(const Target &, Args...);
+    };
+
     /**
      * @brief Callback type for window enumeration
      * @return true to continue enumeration, false to stop
      */
     using EnumWindowsCallback = std::function<bool(const WindowInfo &)>;
 
+    /**
+     * @brief What EnumerateWindows takes: any callable with the EnumWindowsCallback signature
+     */
+    using WindowCallbackRef = FunctionRef<bool(const WindowInfo &)>;
+
+    /**
+     * @brief Callback for EnumerateWindowBatches, given up to EnumerationOptions::batchSize windows at a time
+     * @return true to continue enumeration, false to stop
+     */
+    using WindowBatchCallbackRef = FunctionRef<bool(const WindowInfo *windows, size_t count)>;
+
     /**
      * @brief Window manager class - main interface for window operations
      */
@@ -163,11 +779,54 @@ namespace CrossWindow
          */
         bool Initialize();
 
+        /**
+         * @brief Initialize the window manager on a specific display
+         * @param displayName X display to connect to, e.g. ":1"; empty for the
+         *        default ($DISPLAY). Other platforms only accept an empty name.
+         * @return true if initialization succeeded
+         */
+        bool Initialize(const std::string &displayName);
+
+        /**
+         * @brief Initialize the window manager on a connection the host already has
+         *
+         * The host keeps reading its own event queue; forward the events it reads
+         * with ProcessEvent or ProcessXEvent so cached desktop and monitor state
+         * stays current (Linux only).
+         *
+         * @param connection The host's connection and whether to take ownership
+         * @return true if initialization succeeded
+         */
+        bool Initialize(const ExternalConnection &connection);
+
+        /**
+         * @brief Let the library see an event read by the host from an adopted connection
+         * @param event Linux: an xcb_generic_event_t*
+         * @return true if the event changed cached state
+         */
+        bool ProcessEvent(const void *event);
+
+        /**
+         * @brief Like ProcessEvent, for hosts reading events through Xlib
+         * @param event Linux: an XEvent*
+         * @return true if the event changed cached state
+         */
+        bool ProcessXEvent(const void *event);
+
         /**
          * @brief Check if the window manager is initialized
          */
         bool IsInitialized() const;
 
+        /**
+         * @brief Check whether the display server connection is currently usable
+         *
+         * On Linux a lost X connection does not end the process. The manager
+         * stays initialized but reports ErrorCode::NotConnected, and reconnects
+         * on a later call once the backoff delay has passed.
+         */
+        bool IsConnected() const;
+
         /**
          * @brief Shutdown and cleanup resources
          */
@@ -181,11 +840,47 @@ namespace CrossWindow
          */
         std::vector<WindowInfo> GetAllWindows();
 
+        /**
+         * @brief Get all visible windows using the given enumeration options
+         * @param options Enumeration options (e.g. parallel worker count)
+         * @return Vector of WindowInfo in the same order as GetAllWindows()
+         */
+        std::vector<WindowInfo> GetAllWindows(const EnumerationOptions &options);
+
         /**
          * @brief Enumerate all windows with a callback
+         * @param callback Function called for each window; any callable, not only EnumWindowsCallback
+         */
+        void EnumerateWindows(WindowCallbackRef callback);
+
+        /**
+         * @brief Enumerate all windows with a callback using the given options
+         *
+         * The callback sees each window as soon as its details arrive; returning
+         * false cancels the requests still in flight.
+         *
          * @param callback Function called for each window
+         * @param options Enumeration options (e.g. windowAhead)
          */
-        void EnumerateWindows(const EnumWindowsCallback &callback);
+        void EnumerateWindows(WindowCallbackRef callback, const EnumerationOptions &options);
+
+        /**
+         * @brief Enumerate all windows, handing them to the callback in chunks
+         *
+         * Same windows and order as EnumerateWindows, with one call per
+         * EnumerationOptions::batchSize windows (the last chunk may be shorter).
+         * The pointer is only valid during the call.
+         *
+         * @param callback Function called for each chunk
+         */
+        void EnumerateWindowBatches(WindowBatchCallbackRef callback);
+
+        /**
+         * @brief Enumerate all windows in chunks using the given options
+         * @param callback Function called for each chunk
+         * @param options Enumeration options (e.g. batchSize)
+         */
+        void EnumerateWindowBatches(WindowBatchCallbackRef callback, const EnumerationOptions &options);
 
         /**
          * @brief Find windows by title (partial match)
@@ -203,6 +898,75 @@ namespace CrossWindow
          */
         std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName);
 
+        /**
+         * @brief Find windows by title, giving up at a deadline
+         * @param titlePattern Substring to search for in window titles
+         * @param caseSensitive Whether the search is case-sensitive
+         * @param deadline Windows not fetched by then are left out; WasLastEnumerationPartial() reports it
+         * @return Vector of matching windows
+         */
+        std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern, bool caseSensitive,
+                                                   Deadline deadline);
+
+        /**
+         * @brief Find windows by process name, giving up at a deadline
+         * @param processName Name of the process
+         * @param deadline Windows not fetched by then are left out; WasLastEnumerationPartial() reports it
+         * @return Vector of windows owned by the process
+         */
+        std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName, Deadline deadline);
+
+        /**
+         * @brief Find windows whose process lives in a cgroup
+         * @param pattern Substring of the cgroup path, e.g. a unit name or container id
+         * @return Vector of matching windows, with cgroup fields filled (Linux only)
+         */
+        std::vector<WindowInfo> FindWindowsByCgroup(const std::string &pattern);
+
+        /**
+         * @brief Group windows by the application process that spawned them
+         *
+         * Helper processes (browser renderers, Electron children) are attributed
+         * to the topmost ancestor running the same executable. The process tree
+         * is read once per call (Linux only).
+         *
+         * @return One group per application, in order of first window
+         */
+        std::vector<ApplicationGroup> GroupWindowsByApplication();
+
+        /**
+         * @brief Find windows owned by a process or any of its descendants
+         * @param rootProcessId Process ID at the top of the tree
+         * @return Vector of matching windows (Linux only)
+         */
+        std::vector<WindowInfo> FindWindowsByProcessTree(uint32_t rootProcessId);
+
+        /**
+         * @brief Windows added, removed or modified since an earlier call
+         *
+         * Each call enumerates the windows and compares them with the previous
+         * enumeration; if anything changed, the differences go into a bounded log
+         * under a new generation. A generation older than the log (or 0) gets a
+         * full snapshot instead. A window whose handle was reused (a different
+         * WindowInfo::generation) is reported as removed and added again.
+         *
+         * @param generation WindowChanges::generation of the previous call; 0 the first time
+         */
+        WindowChanges GetChangesSince(uint64_t generation);
+
+        /**
+         * @brief Get all visible windows as a column-oriented table
+         *
+         * Windows are appended as they are enumerated, without a vector of
+         * WindowInfo in between.
+         */
+        WindowTable GetWindowTable();
+
+        /**
+         * @brief Get windows as a table, with enumeration options
+         */
+        WindowTable GetWindowTable(const EnumerationOptions &options);
+
         // ============== Window Information ==============
 
         /**
@@ -212,6 +976,14 @@ namespace CrossWindow
          */
         Result<WindowInfo> GetWindowInfo(NativeHandle handle);
 
+        /**
+         * @brief Get information about a specific window, giving up at a deadline
+         * @param handle Native window handle
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return WindowInfo or error
+         */
+        Result<WindowInfo> GetWindowInfo(NativeHandle handle, Deadline deadline);
+
         /**
          * @brief Get the title of a window
          * @param handle Native window handle
@@ -219,6 +991,14 @@ namespace CrossWindow
          */
         Result<std::string> GetWindowTitle(NativeHandle handle);
 
+        /**
+         * @brief Get the title of a window, giving up at a deadline
+         * @param handle Native window handle
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return Window title or error
+         */
+        Result<std::string> GetWindowTitle(NativeHandle handle, Deadline deadline);
+
         /**
          * @brief Get the window rectangle (position and size)
          * @param handle Native window handle
@@ -226,6 +1006,14 @@ namespace CrossWindow
          */
         Result<Rect> GetWindowRect(NativeHandle handle);
 
+        /**
+         * @brief Get the window rectangle, giving up at a deadline
+         * @param handle Native window handle
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return Window rect or error
+         */
+        Result<Rect> GetWindowRect(NativeHandle handle, Deadline deadline);
+
         /**
          * @brief Get the current state of a window
          * @param handle Native window handle
@@ -233,6 +1021,14 @@ namespace CrossWindow
          */
         Result<WindowState> GetWindowState(NativeHandle handle);
 
+        /**
+         * @brief Get the current state of a window, giving up at a deadline
+         * @param handle Native window handle
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return Window state or error
+         */
+        Result<WindowState> GetWindowState(NativeHandle handle, Deadline deadline);
+
         /**
          * @brief Get the process ID of a window
          * @param handle Native window handle
@@ -240,6 +1036,37 @@ namespace CrossWindow
          */
         Result<uint32_t> GetWindowProcessId(NativeHandle handle);
 
+        /**
+         * @brief Get the process ID of a window, giving up at a deadline
+         * @param handle Native window handle
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return Process ID or error
+         */
+        Result<uint32_t> GetWindowProcessId(NativeHandle handle, Deadline deadline);
+
+        /**
+         * @brief Get a stable id for the window that has a handle now
+         * @return The id, with generation 0 if the window does not exist or is not tracked
+         */
+        WindowId GetWindowId(NativeHandle handle);
+
+        /**
+         * @brief Check whether an id still names the window it was issued for
+         *
+         * On Linux a window destroyed since the id was issued is recognised
+         * without asking the X server; an id from an earlier connection is
+         * always stale.
+         *
+         * @return false if the window is gone or its handle now names another window
+         */
+        bool IsCurrentWindow(const WindowId &id);
+
+        /**
+         * @brief Get information about a window, rejecting stale ids
+         * @return WindowInfo, or ErrorCode::WindowNotFound if the id is stale
+         */
+        Result<WindowInfo> GetWindowInfo(const WindowId &id);
+
         /**
          * @brief Check if a window is visible
          * @param handle Native window handle
@@ -254,6 +1081,76 @@ namespace CrossWindow
          */
         bool IsValidWindow(NativeHandle handle);
 
+        // ============== Window Properties ==============
+
+        /**
+         * @brief Read any property of a window by atom name
+         *
+         * On Linux the value shares the property cache of the built-in fields,
+         * so repeated reads cost no server traffic until the property changes.
+         *
+         * @return The raw value; exists() is false if the window does not have it
+         */
+        Result<WindowProperty> GetWindowProperty(NativeHandle handle, const std::string &atomName);
+
+        /**
+         * @brief Read one property of many windows in a single round trip
+         * @return One result per handle, in the same order
+         */
+        std::vector<Result<WindowProperty>> GetWindowProperties(const std::vector<NativeHandle> &handles,
+                                                                const std::string &atomName);
+
+        /**
+         * @brief Read a property and convert it with PropertyDecoder<T>
+         * @return OperationFailed if the property is not set or has another format
+         */
+        template <typename T>
+        Result<T> GetProperty(NativeHandle handle, const std::string &atomName)
+        {
+            return DecodeProperty<T>(GetWindowProperty(handle, atomName));
+        }
+
+        /**
+         * @brief Read and convert a property of many windows in a single round trip
+         */
+        template <typename T>
+        std::vector<Result<T>> GetProperties(const std::vector<NativeHandle> &handles, const std::string &atomName)
+        {
+            std::vector<Result<T>> results;
+            for (auto &property : GetWindowProperties(handles, atomName))
+            {
+                results.push_back(DecodeProperty<T>(std::move(property)));
+            }
+            return results;
+        }
+
+        /**
+         * @brief Call back whenever a property of a window changes
+         *
+         * Callbacks run from PollEvents(), or from ProcessEvent()/ProcessXEvent()
+         * on an adopted connection, never in the middle of another call. Watches
+         * end when the window is destroyed or the connection is replaced.
+         *
+         * @return Watch id for UnwatchProperty, or 0 on failure
+         */
+        int WatchProperty(NativeHandle handle, const std::string &atomName, PropertyChangeCallback callback);
+
+        /**
+         * @brief Stop a watch started by WatchProperty
+         * @return false if the id is unknown
+         */
+        bool UnwatchProperty(int watchId);
+
+        /**
+         * @brief Handle the events that arrived since the last call
+         *
+         * On Linux every other call handles pending events first as well, so they never
+         * pile up between calls. A program that stays idle for long should still
+         * call this now and then, since followed windows keep sending events.
+         * @return true if any property watch was called
+         */
+        bool PollEvents();
+
         // ============== Active/Focused Window ==============
 
         /**
@@ -268,6 +1165,73 @@ namespace CrossWindow
          */
         Result<WindowInfo> GetFocusedWindowInfo();
 
+        /**
+         * @brief Get information about the currently focused window, giving up at a deadline
+         * @param deadline Point in time after which ErrorCode::Timeout is returned
+         * @return WindowInfo for the focused window
+         */
+        Result<WindowInfo> GetFocusedWindowInfo(Deadline deadline);
+
+        // ============== Virtual Desktops ==============
+
+        /**
+         * @brief Get the index of the active virtual desktop
+         * @return Desktop index, or -1 if the window manager does not report one
+         */
+        int GetCurrentDesktop();
+
+        /**
+         * @brief Get the number of virtual desktops
+         * @return Desktop count, or 0 if the window manager does not report one
+         */
+        int GetDesktopCount();
+
+        // ============== Monitors ==============
+
+        /**
+         * @brief Get the monitors making up the desktop
+         *
+         * On Linux the list comes from XRandR and is cached until the server
+         * reports a screen change. Without XRandR the whole screen is reported
+         * as one monitor.
+         *
+         * @return Monitors in server order; WindowInfo::monitor indexes this list
+         */
+        std::vector<MonitorInfo> GetMonitors();
+
+        /**
+         * @brief Find windows shown mostly on a monitor
+         * @param monitorIndex Index into GetMonitors()
+         * @return Windows whose largest overlap is with that monitor
+         */
+        std::vector<WindowInfo> FindWindowsOnMonitor(int monitorIndex);
+
+        // ============== Process Resources ==============
+
+        /**
+         * @brief Get all windows with the CPU and memory use of their processes
+         *
+         * Each process is sampled once per call, however many windows it owns.
+         * cpuPercent covers the time since the previous call (Linux only).
+         *
+         * @return One entry per window
+         */
+        std::vector<WindowResourceUsage> GetWindowResourceUsage();
+
+        /**
+         * @brief Sample the process owning one window
+         * @param handle Native window handle
+         * @return Resource usage or error
+         */
+        Result<ResourceUsage> GetWindowResourceUsage(NativeHandle handle);
+
+        /**
+         * @brief Get the recent samples kept for a process
+         * @param processId Process ID
+         * @return Up to 16 samples, oldest first
+         */
+        std::vector<ResourceUsage> GetProcessUsageHistory(uint32_t processId);
+
         // ============== Window Manipulation ==============
 
         /**
@@ -284,6 +1248,28 @@ namespace CrossWindow
          */
         ErrorCode ForceCloseWindow(NativeHandle handle);
 
+        /**
+         * @brief Close a window gracefully, unless the id is stale
+         * @return ErrorCode::WindowNotFound if the id no longer names its window
+         */
+        ErrorCode CloseWindow(const WindowId &id);
+
+        /**
+         * @brief Force close a window, unless the id is stale
+         * @return ErrorCode::WindowNotFound if the id no longer names its window
+         */
+        ErrorCode ForceCloseWindow(const WindowId &id);
+
+        /**
+         * @brief Ask every window of a process and its descendants to close
+         *
+         * All close requests are sent in one batch after a single enumeration.
+         *
+         * @param rootProcessId Process ID at the top of the tree
+         * @return Success, WindowNotFound if the tree owns no windows, or NotSupported
+         */
+        ErrorCode CloseProcessTreeWindows(uint32_t rootProcessId);
+
         /**
          * @brief Minimize a window
          * @param handle Native window handle
@@ -326,6 +1312,12 @@ namespace CrossWindow
          */
         ErrorCode FocusWindow(NativeHandle handle);
 
+        /**
+         * @brief Bring a window to the foreground, unless the id is stale
+         * @return ErrorCode::WindowNotFound if the id no longer names its window
+         */
+        ErrorCode FocusWindow(const WindowId &id);
+
         /**
          * @brief Set window always on top
          * @param handle Native window handle
@@ -384,6 +1376,30 @@ namespace CrossWindow
          */
         std::string GetLastError() const;
 
+        /**
+         * @brief Set the size caps applied when reading window properties
+         * @param limits New limits (Linux; other platforms ignore them)
+         */
+        void SetPropertyLimits(const PropertyLimits &limits);
+
+        /**
+         * @brief Get the size caps applied when reading window properties
+         */
+        PropertyLimits GetPropertyLimits() const;
+
+        /**
+         * @brief Get the strategy used by the most recent enumeration
+         * @return ClientList or TreeWalk on Linux, Native elsewhere
+         */
+        EnumerationStrategy GetLastEnumerationStrategy() const;
+
+        /**
+         * @brief Check whether the most recent enumeration hit its deadline, lost
+         *        the display connection part way or was cut at maxClientListWindows
+         * @return true if windows may be missing from the last result
+         */
+        bool WasLastEnumerationPartial() const;
+
         /**
          * @brief Get platform name
          * @return "Windows", "Linux", "macOS", or "Stub"
@@ -391,11 +1407,151 @@ namespace CrossWindow
         static const char *GetPlatformName();
 
     private:
+        template <typename T>
+        static Result<T> DecodeProperty(Result<WindowProperty> property)
+        {
+            Result<T> result;
+            result.error = property.error;
+            result.errorMessage = std::move(property.errorMessage);
+            if (property.ok() && !PropertyDecoder<T>::Decode(property.value, result.value))
+            {
+                result.error = ErrorCode::OperationFailed;
+                if (property.value.exists())
+                {
+                    result.errorMessage = "Property has another format"_msg;
+                }
+                else
+                {
+                    result.errorMessage = "Property is not set"_msg;
+                }
+            }
+            return result;
+        }
+
         class Impl;
         friend class Impl;
         std::unique_ptr<Impl> m_impl;
     };
 
+    /**
+     * @brief A window handle qualified by the display it lives on
+     */
+    struct DisplayHandle
+    {
+        int display = -1;      ///< Index returned by MultiDisplayManager::AddDisplay
+        NativeHandle handle{}; ///< Native handle, only meaningful on that display
+
+        bool operator==(const DisplayHandle &other) const
+        {
+            return display == other.display && handle == other.handle;
+        }
+        bool operator!=(const DisplayHandle &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief A window found by MultiDisplayManager
+     */
+    struct DisplayWindowInfo
+    {
+        DisplayHandle id;
+        std::string displayName; ///< Display the window lives on
+        WindowInfo window;
+    };
+
+    /**
+     * @brief Several displays managed together, each by its own WindowManager
+     *
+     * Every display is driven by a dedicated thread that owns its WindowManager,
+     * so a query across displays runs on all of them at once and takes as long
+     * as the slowest display rather than the sum. Results are merged in display
+     * order. Calls into a MultiDisplayManager itself must not overlap.
+     */
+    class CROSSWINDOW_API MultiDisplayManager
+    {
+    public:
+        MultiDisplayManager();
+        ~MultiDisplayManager();
+
+        // Non-copyable, movable
+        MultiDisplayManager(const MultiDisplayManager &) = delete;
+        MultiDisplayManager &operator=(const MultiDisplayManager &) = delete;
+        MultiDisplayManager(MultiDisplayManager &&) noexcept;
+        MultiDisplayManager &operator=(MultiDisplayManager &&) noexcept;
+
+        /**
+         * @brief Connect to a display and start its thread
+         * @param displayName Display to connect to, e.g. ":1"
+         * @return Index of the display, or -1 if it could not be initialized
+         */
+        int AddDisplay(const std::string &displayName);
+
+        /**
+         * @brief Disconnect from every display and stop their threads
+         */
+        void Shutdown();
+
+        /**
+         * @brief Number of displays added
+         */
+        int GetDisplayCount() const;
+
+        /**
+         * @brief Name a display was added under
+         * @return Empty string for an unknown index
+         */
+        std::string GetDisplayName(int display) const;
+
+        /**
+         * @brief Get all windows of every display
+         * @param options Applied to each display
+         * @return Windows of display 0 first, then display 1, and so on
+         */
+        std::vector<DisplayWindowInfo> GetAllWindows(const EnumerationOptions &options = {});
+
+        /**
+         * @brief Find windows by title (partial match) on every display
+         */
+        std::vector<DisplayWindowInfo> FindWindowsByTitle(const std::string &titlePattern,
+                                                          bool caseSensitive = false);
+
+        /**
+         * @brief Find windows by process name on every display
+         */
+        std::vector<DisplayWindowInfo> FindWindowsByProcess(const std::string &processName);
+
+        /**
+         * @brief Get information about a window on one of the displays
+         */
+        Result<WindowInfo> GetWindowInfo(const DisplayHandle &id);
+
+        /**
+         * @brief Close a window on one of the displays gracefully
+         */
+        ErrorCode CloseWindow(const DisplayHandle &id);
+
+        /**
+         * @brief Bring a window on one of the displays to the foreground
+         */
+        ErrorCode FocusWindow(const DisplayHandle &id);
+
+        /**
+         * @brief Run a function on the thread of one display
+         *
+         * For operations not wrapped above. Blocks until the function returns.
+         * @return false for an unknown display index
+         */
+        bool Invoke(int display, const std::function<void(WindowManager &)> &function);
+
+        /**
+         * @brief Get the last error message
+         */
+        std::string GetLastError() const;
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
     // Forward declare the Impl for platform implementations
     class WindowManagerImpl;
 
@@ -0,0 +1,183 @@
+/**
+ * @file ChangeLog.cpp
+ * @brief Window list differences between successive enumerations
+ */
+
+#include "ChangeLog.h"
+#include <utility>
+
+namespace CrossWindow
+{
+
+    WindowField ChangeLog::Differences(const WindowInfo &before, const WindowInfo &after)
+    {
+        WindowField fields = WindowField::None;
+        if (before.title != after.title || before.titleTruncated != after.titleTruncated)
+            fields = fields | WindowField::Title;
+        if (before.className != after.className)
+            fields = fields | WindowField::ClassName;
+        if (before.rect.x != after.rect.x || before.rect.y != after.rect.y ||
+            before.rect.width != after.rect.width || before.rect.height != after.rect.height)
+            fields = fields | WindowField::Rect;
+        if (before.state != after.state)
+            fields = fields | WindowField::State;
+        if (before.processId != after.processId || before.processName != after.processName)
+            fields = fields | WindowField::Process;
+        if (before.isVisible != after.isVisible)
+            fields = fields | WindowField::Visibility;
+        if (before.desktop != after.desktop)
+            fields = fields | WindowField::Desktop;
+        if (before.type != after.type || before.skipTaskbar != after.skipTaskbar ||
+            before.skipPager != after.skipPager)
+            fields = fields | WindowField::Type;
+        if (before.monitor != after.monitor)
+            fields = fields | WindowField::Monitor;
+        if (before.cgroupPath != after.cgroupPath || before.cgroupUnit != after.cgroupUnit ||
+            before.containerId != after.containerId)
+            fields = fields | WindowField::Cgroup;
+        return fields;
+    }
+
+    void ChangeLog::Append(WindowChange change)
+    {
+        m_log.push_back(Entry{m_generation + 1, std::move(change)});
+    }
+
+    void ChangeLog::Update(std::vector<WindowInfo> windows)
+    {
+        std::unordered_map<NativeHandle, const WindowInfo *> previous;
+        previous.reserve(m_windows.size());
+        for (const auto &info : m_windows)
+        {
+            previous.emplace(info.handle, &info);
+        }
+
+        size_t logged = m_log.size();
+        std::unordered_map<NativeHandle, bool> present;
+        present.reserve(windows.size());
+        for (const auto &info : windows)
+        {
+            present.emplace(info.handle, true);
+            auto it = previous.find(info.handle);
+            if (it != previous.end() && it->second->generation != info.generation)
+            {
+                // Same handle, different window: the old one is gone
+                WindowChange removed;
+                removed.kind = WindowChange::Kind::Removed;
+                removed.window.handle = info.handle;
+                Append(std::move(removed));
+                it = previous.end();
+            }
+
+            WindowChange change;
+            change.window = info;
+            if (it == previous.end())
+            {
+                change.kind = WindowChange::Kind::Added;
+                change.fields = WindowField::All;
+                Append(std::move(change));
+            }
+            else if ((change.fields = Differences(*it->second, info)) != WindowField::None)
+            {
+                change.kind = WindowChange::Kind::Modified;
+                Append(std::move(change));
+            }
+        }
+
+        for (const auto &info : m_windows)
+        {
+            if (!present.count(info.handle))
+            {
+                WindowChange removed;
+                removed.kind = WindowChange::Kind::Removed;
+                removed.window.handle = info.handle;
+                Append(std::move(removed));
+            }
+        }
+
+        m_windows = std::move(windows);
+
+        // The first list always gets a generation so callers have one to pass back
+        if (m_log.size() == logged && m_generation != 0)
+        {
+            return;
+        }
+
+        m_generation++;
+        while (m_log.size() > m_maxEntries)
+        {
+            m_complete = m_log.front().generation;
+            m_log.pop_front();
+        }
+    }
+
+    WindowChanges ChangeLog::Since(uint64_t generation) const
+    {
+        WindowChanges result;
+        result.generation = m_generation;
+
+        // Generation 0 is before the first enumeration, which the log never holds
+        if (generation == 0 || generation < m_complete || generation > m_generation)
+        {
+            result.fullSnapshot = true;
+            result.snapshot = m_windows;
+            return result;
+        }
+
+        // Later changes to a window fold into its latest entry; a removal only
+        // starts a new entry so a reused handle still reads as removed, then added
+        std::unordered_map<NativeHandle, size_t> latest;
+        std::vector<bool> dropped;
+        for (const auto &entry : m_log)
+        {
+            if (entry.generation <= generation)
+            {
+                continue;
+            }
+
+            const WindowChange &change = entry.change;
+            auto it = latest.find(change.window.handle);
+            if (it == latest.end() ||
+                result.changes[it->second].kind == WindowChange::Kind::Removed)
+            {
+                latest[change.window.handle] = result.changes.size();
+                result.changes.push_back(change);
+                dropped.push_back(false);
+                continue;
+            }
+
+            WindowChange &merged = result.changes[it->second];
+            if (change.kind == WindowChange::Kind::Removed)
+            {
+                if (merged.kind == WindowChange::Kind::Added)
+                {
+                    // Came and went in between: the caller never saw it
+                    dropped[it->second] = true;
+                    latest.erase(it);
+                }
+                else
+                {
+                    merged = change;
+                }
+            }
+            else
+            {
+                merged.fields = merged.fields | change.fields;
+                merged.window = change.window;
+            }
+        }
+
+        std::vector<WindowChange> kept;
+        kept.reserve(result.changes.size());
+        for (size_t i = 0; i < result.changes.size(); ++i)
+        {
+            if (!dropped[i])
+            {
+                kept.push_back(std::move(result.changes[i]));
+            }
+        }
+        result.changes = std::move(kept);
+        return result;
+    }
+
+} // namespace CrossWindow
@@ -0,0 +1,55 @@
+/**
+ * @file ChangeLog.h
+ * @brief Window list differences between successive enumerations
+ */
+
+#pragma once
+
+#include "CrossWindow.h"
+#include <deque>
+#include <unordered_map>
+
+namespace CrossWindow
+{
+
+    /**
+     * @brief Keeps the last window list and a bounded log of how it changed
+     *
+     * Every Update that differs from the previous list gets the next
+     * generation. Since(g) answers from the log while it still holds every
+     * change after g, and with a full snapshot once older entries were dropped.
+     */
+    class ChangeLog
+    {
+    public:
+        static constexpr size_t kDefaultMaxEntries = 4096;
+
+        explicit ChangeLog(size_t maxEntries = kDefaultMaxEntries) : m_maxEntries(maxEntries) {}
+
+        /**
+         * @brief Compare a complete enumeration with the previous one and log the differences
+         */
+        void Update(std::vector<WindowInfo> windows);
+
+        WindowChanges Since(uint64_t generation) const;
+
+        uint64_t Generation() const { return m_generation; }
+
+    private:
+        struct Entry
+        {
+            uint64_t generation = 0;
+            WindowChange change;
+        };
+
+        static WindowField Differences(const WindowInfo &before, const WindowInfo &after);
+        void Append(WindowChange change);
+
+        size_t m_maxEntries;
+        uint64_t m_generation = 0;
+        uint64_t m_complete = 0; ///< The log holds every change after this generation
+        std::deque<Entry> m_log;
+        std::vector<WindowInfo> m_windows; ///< Last enumeration, in its order
+    };
+
+} // namespace CrossWindow
@@ -0,0 +1,272 @@
+/**
+ * @file MultiDisplayManager.cpp
+ * @brief Several displays managed together, one thread per display
+ */
+
+#include "CrossWindow.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace CrossWindow
+{
+
+    namespace
+    {
+        /**
+         * @brief Owns the WindowManager of one display and runs every call to it
+         *        on its own thread
+         */
+        class DisplayWorker
+        {
+        public:
+            explicit DisplayWorker(std::string name)
+                : m_name(std::move(name)), m_thread([this]()
+                                                    { Run(); })
+            {
+            }
+
+            ~DisplayWorker()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wake.notify_one();
+                m_thread.join();
+            }
+
+            DisplayWorker(const DisplayWorker &) = delete;
+            DisplayWorker &operator=(const DisplayWorker &) = delete;
+
+            const std::string &Name() const { return m_name; }
+
+            /**
+             * @brief Queue a call against the manager; the future yields its result
+             */
+            template <typename F>
+            auto Post(F function) -> std::future<decltype(function(std::declval<WindowManager &>()))>
+            {
+                using R = decltype(function(std::declval<WindowManager &>()));
+                auto task = std::make_shared<std::packaged_task<R()>>(
+                    [this, function]() mutable
+                    { return function(m_manager); });
+                auto future = task->get_future();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_tasks.emplace_back([task]()
+                                         { (*task)(); });
+                }
+                m_wake.notify_one();
+                return future;
+            }
+
+        private:
+            void Run()
+            {
+                for (;;)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wake.wait(lock, [this]()
+                                    { return m_stopping || !m_tasks.empty(); });
+                        if (m_tasks.empty())
+                        {
+                            break;
+                        }
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+
+                // The connection is closed on the thread that opened it
+                m_manager.Shutdown();
+            }
+
+            std::string m_name;
+            WindowManager m_manager;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::deque<std::function<void()>> m_tasks;
+            bool m_stopping = false;
+            std::thread m_thread; // Last, so everything above exists before it starts
+        };
+    } // namespace
+
+    class MultiDisplayManager::Impl
+    {
+    public:
+        std::vector<std::unique_ptr<DisplayWorker>> workers;
+        std::string lastError;
+
+        DisplayWorker *Find(int display)
+        {
+            if (display < 0 || static_cast<size_t>(display) >= workers.size())
+            {
+                lastError = "Unknown display index";
+                return nullptr;
+            }
+            return workers[display].get();
+        }
+
+        /**
+         * @brief Run a window query on every display at once and merge the results
+         */
+        template <typename F>
+        std::vector<DisplayWindowInfo> Gather(F query)
+        {
+            std::vector<std::future<std::vector<WindowInfo>>> pending;
+            pending.reserve(workers.size());
+            for (auto &worker : workers)
+            {
+                pending.push_back(worker->Post(query));
+            }
+
+            std::vector<DisplayWindowInfo> merged;
+            for (size_t d = 0; d < pending.size(); ++d)
+            {
+                for (auto &info : pending[d].get())
+                {
+                    DisplayWindowInfo entry;
+                    entry.id = {static_cast<int>(d), info.handle};
+                    entry.displayName = workers[d]->Name();
+                    entry.window = std::move(info);
+                    merged.push_back(std::move(entry));
+                }
+            }
+            return merged;
+        }
+    };
+
+    MultiDisplayManager::MultiDisplayManager() : m_impl(std::make_unique<Impl>())
+    {
+    }
+
+    MultiDisplayManager::~MultiDisplayManager()
+    {
+        if (m_impl)
+        {
+            Shutdown();
+        }
+    }
+
+    MultiDisplayManager::MultiDisplayManager(MultiDisplayManager &&) noexcept = default;
+    MultiDisplayManager &MultiDisplayManager::operator=(MultiDisplayManager &&) noexcept = default;
+
+    int MultiDisplayManager::AddDisplay(const std::string &displayName)
+    {
+        auto worker = std::make_unique<DisplayWorker>(displayName);
+        auto opened = worker->Post([&displayName](WindowManager &wm)
+                                   { return wm.Initialize(displayName) ? std::string() : wm.GetLastError(); })
+                          .get();
+        if (!opened.empty())
+        {
+            m_impl->lastError = opened;
+            return -1;
+        }
+
+        m_impl->workers.push_back(std::move(worker));
+        return static_cast<int>(m_impl->workers.size() - 1);
+    }
+
+    void MultiDisplayManager::Shutdown()
+    {
+        m_impl->workers.clear();
+    }
+
+    int MultiDisplayManager::GetDisplayCount() const
+    {
+        return static_cast<int>(m_impl->workers.size());
+    }
+
+    std::string MultiDisplayManager::GetDisplayName(int display) const
+    {
+        if (display < 0 || static_cast<size_t>(display) >= m_impl->workers.size())
+        {
+            return {};
+        }
+        return m_impl->workers[display]->Name();
+    }
+
+    std::vector<DisplayWindowInfo> MultiDisplayManager::GetAllWindows(const EnumerationOptions &options)
+    {
+        return m_impl->Gather([&options](WindowManager &wm)
+                              { return wm.GetAllWindows(options); });
+    }
+
+    std::vector<DisplayWindowInfo> MultiDisplayManager::FindWindowsByTitle(const std::string &titlePattern,
+                                                                           bool caseSensitive)
+    {
+        return m_impl->Gather([&titlePattern, caseSensitive](WindowManager &wm)
+                              { return wm.FindWindowsByTitle(titlePattern, caseSensitive); });
+    }
+
+    std::vector<DisplayWindowInfo> MultiDisplayManager::FindWindowsByProcess(const std::string &processName)
+    {
+        return m_impl->Gather([&processName](WindowManager &wm)
+                              { return wm.FindWindowsByProcess(processName); });
+    }
+
+    Result<WindowInfo> MultiDisplayManager::GetWindowInfo(const DisplayHandle &id)
+    {
+        DisplayWorker *worker = m_impl->Find(id.display);
+        if (!worker)
+        {
+            return {WindowInfo{}, ErrorCode::InvalidHandle, m_impl->lastError};
+        }
+        NativeHandle handle = id.handle;
+        return worker->Post([handle](WindowManager &wm)
+                            { return wm.GetWindowInfo(handle); })
+            .get();
+    }
+
+    ErrorCode MultiDisplayManager::CloseWindow(const DisplayHandle &id)
+    {
+        DisplayWorker *worker = m_impl->Find(id.display);
+        if (!worker)
+        {
+            return ErrorCode::InvalidHandle;
+        }
+        NativeHandle handle = id.handle;
+        return worker->Post([handle](WindowManager &wm)
+                            { return wm.CloseWindow(handle); })
+            .get();
+    }
+
+    ErrorCode MultiDisplayManager::FocusWindow(const DisplayHandle &id)
+    {
+        DisplayWorker *worker = m_impl->Find(id.display);
+        if (!worker)
+        {
+            return ErrorCode::InvalidHandle;
+        }
+        NativeHandle handle = id.handle;
+        return worker->Post([handle](WindowManager &wm)
+                            { return wm.FocusWindow(handle); })
+            .get();
+    }
+
+    bool MultiDisplayManager::Invoke(int display, const std::function<void(WindowManager &)> &function)
+    {
+        DisplayWorker *worker = m_impl->Find(display);
+        if (!worker)
+        {
+            return false;
+        }
+        worker->Post([&function](WindowManager &wm)
+                     { function(wm); })
+            .get();
+        return true;
+    }
+
+    std::string MultiDisplayManager::GetLastError() const
+    {
+        return m_impl->lastError;
+    }
+
+} // namespace CrossWindow
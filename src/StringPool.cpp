@@ -0,0 +1,76 @@
+/**
+ * @file StringPool.cpp
+ * @brief Process-wide interning of class and process names
+ */
+
+#include "CrossWindow.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace CrossWindow
+{
+
+    namespace
+    {
+        struct Pool
+        {
+            std::shared_mutex mutex;
+            std::deque<std::string> strings{std::string()};                      ///< Index is the id; elements never move
+            std::unordered_map<std::string_view, StringId> ids{{std::string_view(), 0}}; ///< Views into strings
+        };
+
+        Pool &GetPool()
+        {
+            // Never destroyed, so views stay valid while other statics shut down
+            static Pool *pool = new Pool();
+            return *pool;
+        }
+    } // namespace
+
+    StringId StringPool::Intern(std::string_view value)
+    {
+        if (value.empty())
+        {
+            return 0;
+        }
+
+        Pool &pool = GetPool();
+        {
+            std::shared_lock<std::shared_mutex> lock(pool.mutex);
+            auto it = pool.ids.find(value);
+            if (it != pool.ids.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(pool.mutex);
+        auto it = pool.ids.find(value);
+        if (it != pool.ids.end())
+        {
+            return it->second;
+        }
+
+        StringId id = static_cast<StringId>(pool.strings.size());
+        pool.strings.emplace_back(value);
+        pool.ids.emplace(pool.strings.back(), id);
+        return id;
+    }
+
+    std::string_view StringPool::View(StringId id)
+    {
+        Pool &pool = GetPool();
+        std::shared_lock<std::shared_mutex> lock(pool.mutex);
+        return id < pool.strings.size() ? std::string_view(pool.strings[id]) : std::string_view();
+    }
+
+    size_t StringPool::Size()
+    {
+        Pool &pool = GetPool();
+        std::shared_lock<std::shared_mutex> lock(pool.mutex);
+        return pool.strings.size();
+    }
+
+} // namespace CrossWindow
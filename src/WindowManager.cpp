@@ -5,12 +5,15 @@
 
 #include "CrossWindow.h"
 #include "WindowManagerImpl.h"
+#include "ChangeLog.h"
 
 // Include platform-specific implementations
 #ifdef CROSSWINDOW_WINDOWS
 #include "platform/windows/WindowManagerWindows.h"
 #elif defined(CROSSWINDOW_LINUX)
 #include "platform/linux/WindowManagerLinux.h"
+// X11 defines Success as a macro, which conflicts with ErrorCode::Success
+#undef Success
 #elif defined(CROSSWINDOW_MACOS)
 #include "platform/macos/WindowManagerMacOS.h"
 #else
@@ -20,33 +23,55 @@
 namespace CrossWindow
 {
 
+#ifdef CROSSWINDOW_WINDOWS
+    using PlatformBackend = WindowManagerWindows;
+#elif defined(CROSSWINDOW_LINUX)
+    using PlatformBackend = WindowManagerLinux;
+#elif defined(CROSSWINDOW_MACOS)
+    using PlatformBackend = WindowManagerMacOS;
+#else
+    using PlatformBackend = WindowManagerStub;
+#endif
+
+#ifdef CROSSWINDOW_STATIC_DISPATCH
+    // The backend is held by value and reached through its final type, so every
+    // forwarder below is a direct call the compiler may inline. The outer pimpl
+    // stays so CrossWindow.h does not depend on the platform headers
+    class WindowManager::Impl
+    {
+    public:
+        PlatformBackend backend;
+        ChangeLog changes;
+
+        PlatformBackend &Backend() { return backend; }
+    };
+
+    WindowManager::WindowManager() : m_impl(std::make_unique<Impl>())
+    {
+    }
+#else
     // Define the private Impl class as a wrapper around WindowManagerImplBase
     class WindowManager::Impl
     {
     public:
         std::unique_ptr<WindowManagerImplBase> impl;
+        ChangeLog changes;
 
         explicit Impl(std::unique_ptr<WindowManagerImplBase> p) : impl(std::move(p)) {}
+
+        WindowManagerImplBase &Backend() { return *impl; }
     };
 
-    WindowManager::WindowManager()
+    WindowManager::WindowManager() : m_impl(std::make_unique<Impl>(std::make_unique<PlatformBackend>()))
     {
-#ifdef CROSSWINDOW_WINDOWS
-        m_impl = std::make_unique<Impl>(std::make_unique<WindowManagerWindows>());
-#elif defined(CROSSWINDOW_LINUX)
-        m_impl = std::make_unique<Impl>(std::make_unique<WindowManagerLinux>());
-#elif defined(CROSSWINDOW_MACOS)
-        m_impl = std::make_unique<Impl>(std::make_unique<WindowManagerMacOS>());
-#else
-        m_impl = std::make_unique<Impl>(std::make_unique<WindowManagerStub>());
-#endif
     }
+#endif
 
     WindowManager::~WindowManager()
     {
-        if (m_impl && m_impl->impl && m_impl->impl->IsInitialized())
+        if (m_impl && m_impl->Backend().IsInitialized())
         {
-            m_impl->impl->Shutdown();
+            m_impl->Backend().Shutdown();
         }
     }
 
@@ -55,158 +80,431 @@ namespace CrossWindow
 
     bool WindowManager::Initialize()
     {
-        return m_impl->impl->Initialize();
+        return m_impl->Backend().Initialize();
+    }
+
+    bool WindowManager::Initialize(const std::string &displayName)
+    {
+        return m_impl->Backend().Initialize(displayName);
+    }
+
+    bool WindowManager::Initialize(const ExternalConnection &connection)
+    {
+        return m_impl->Backend().Initialize(connection);
+    }
+
+    bool WindowManager::ProcessEvent(const void *event)
+    {
+        return m_impl->Backend().ProcessEvent(event);
+    }
+
+    bool WindowManager::ProcessXEvent(const void *event)
+    {
+        return m_impl->Backend().ProcessXEvent(event);
     }
 
     bool WindowManager::IsInitialized() const
     {
-        return m_impl->impl->IsInitialized();
+        return m_impl->Backend().IsInitialized();
+    }
+
+    bool WindowManager::IsConnected() const
+    {
+        return m_impl->Backend().IsConnected();
     }
 
     void WindowManager::Shutdown()
     {
-        m_impl->impl->Shutdown();
+        m_impl->Backend().Shutdown();
     }
 
     std::vector<WindowInfo> WindowManager::GetAllWindows()
     {
-        return m_impl->impl->GetAllWindows();
+        return m_impl->Backend().GetAllWindows();
     }
 
-    void WindowManager::EnumerateWindows(const EnumWindowsCallback &callback)
+    std::vector<WindowInfo> WindowManager::GetAllWindows(const EnumerationOptions &options)
     {
-        m_impl->impl->EnumerateWindows(callback);
+        return m_impl->Backend().GetAllWindows(options);
+    }
+
+    WindowChanges WindowManager::GetChangesSince(uint64_t generation)
+    {
+        std::vector<WindowInfo> windows = m_impl->Backend().GetAllWindows();
+
+        // A partial list would read as mass removals
+        if (!m_impl->Backend().WasLastEnumerationPartial())
+        {
+            m_impl->changes.Update(std::move(windows));
+        }
+        return m_impl->changes.Since(generation);
+    }
+
+    WindowTable WindowManager::GetWindowTable()
+    {
+        WindowTable table;
+        auto append = [&table](const WindowInfo &info)
+        {
+            table.Append(info);
+            return true;
+        };
+        m_impl->Backend().EnumerateWindows(append);
+        return table;
+    }
+
+    WindowTable WindowManager::GetWindowTable(const EnumerationOptions &options)
+    {
+        WindowTable table;
+        auto append = [&table](const WindowInfo &info)
+        {
+            table.Append(info);
+            return true;
+        };
+        m_impl->Backend().EnumerateWindows(append, options);
+        return table;
+    }
+
+    void WindowManager::EnumerateWindows(WindowCallbackRef callback)
+    {
+        m_impl->Backend().EnumerateWindows(callback);
+    }
+
+    void WindowManager::EnumerateWindows(WindowCallbackRef callback, const EnumerationOptions &options)
+    {
+        m_impl->Backend().EnumerateWindows(callback, options);
+    }
+
+    void WindowManager::EnumerateWindowBatches(WindowBatchCallbackRef callback)
+    {
+        m_impl->Backend().EnumerateWindowBatches(callback, EnumerationOptions{});
+    }
+
+    void WindowManager::EnumerateWindowBatches(WindowBatchCallbackRef callback, const EnumerationOptions &options)
+    {
+        m_impl->Backend().EnumerateWindowBatches(callback, options);
     }
 
     std::vector<WindowInfo> WindowManager::FindWindowsByTitle(const std::string &titlePattern,
                                                               bool caseSensitive)
     {
-        return m_impl->impl->FindWindowsByTitle(titlePattern, caseSensitive);
+        return m_impl->Backend().FindWindowsByTitle(titlePattern, caseSensitive);
+    }
+
+    std::vector<WindowInfo> WindowManager::FindWindowsByTitle(const std::string &titlePattern, bool caseSensitive,
+                                                              Deadline deadline)
+    {
+        return m_impl->Backend().FindWindowsByTitle(titlePattern, caseSensitive, deadline);
     }
 
     std::vector<WindowInfo> WindowManager::FindWindowsByProcess(const std::string &processName)
     {
-        return m_impl->impl->FindWindowsByProcess(processName);
+        return m_impl->Backend().FindWindowsByProcess(processName);
+    }
+
+    std::vector<WindowInfo> WindowManager::FindWindowsByProcess(const std::string &processName, Deadline deadline)
+    {
+        return m_impl->Backend().FindWindowsByProcess(processName, deadline);
+    }
+
+    std::vector<WindowInfo> WindowManager::FindWindowsByCgroup(const std::string &pattern)
+    {
+        return m_impl->Backend().FindWindowsByCgroup(pattern);
+    }
+
+    std::vector<ApplicationGroup> WindowManager::GroupWindowsByApplication()
+    {
+        return m_impl->Backend().GroupWindowsByApplication();
+    }
+
+    std::vector<WindowInfo> WindowManager::FindWindowsByProcessTree(uint32_t rootProcessId)
+    {
+        return m_impl->Backend().FindWindowsByProcessTree(rootProcessId);
     }
 
     Result<WindowInfo> WindowManager::GetWindowInfo(NativeHandle handle)
     {
-        return m_impl->impl->GetWindowInfo(handle);
+        return m_impl->Backend().GetWindowInfo(handle);
+    }
+
+    Result<WindowInfo> WindowManager::GetWindowInfo(NativeHandle handle, Deadline deadline)
+    {
+        return m_impl->Backend().GetWindowInfo(handle, deadline);
+    }
+
+    Result<WindowInfo> WindowManager::GetWindowInfo(const WindowId &id)
+    {
+        Result<WindowInfo> result;
+        result.error = m_impl->Backend().CheckWindowId(id);
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = m_impl->Backend().GetLastError();
+            return result;
+        }
+        return m_impl->Backend().GetWindowInfo(id.handle);
     }
 
     Result<std::string> WindowManager::GetWindowTitle(NativeHandle handle)
     {
-        return m_impl->impl->GetWindowTitle(handle);
+        return m_impl->Backend().GetWindowTitle(handle);
+    }
+
+    Result<std::string> WindowManager::GetWindowTitle(NativeHandle handle, Deadline deadline)
+    {
+        return m_impl->Backend().GetWindowTitle(handle, deadline);
     }
 
     Result<Rect> WindowManager::GetWindowRect(NativeHandle handle)
     {
-        return m_impl->impl->GetWindowRect(handle);
+        return m_impl->Backend().GetWindowRect(handle);
+    }
+
+    Result<Rect> WindowManager::GetWindowRect(NativeHandle handle, Deadline deadline)
+    {
+        return m_impl->Backend().GetWindowRect(handle, deadline);
     }
 
     Result<WindowState> WindowManager::GetWindowState(NativeHandle handle)
     {
-        return m_impl->impl->GetWindowState(handle);
+        return m_impl->Backend().GetWindowState(handle);
+    }
+
+    Result<WindowState> WindowManager::GetWindowState(NativeHandle handle, Deadline deadline)
+    {
+        return m_impl->Backend().GetWindowState(handle, deadline);
     }
 
     Result<uint32_t> WindowManager::GetWindowProcessId(NativeHandle handle)
     {
-        return m_impl->impl->GetWindowProcessId(handle);
+        return m_impl->Backend().GetWindowProcessId(handle);
+    }
+
+    Result<uint32_t> WindowManager::GetWindowProcessId(NativeHandle handle, Deadline deadline)
+    {
+        return m_impl->Backend().GetWindowProcessId(handle, deadline);
     }
 
     bool WindowManager::IsWindowVisible(NativeHandle handle)
     {
-        return m_impl->impl->IsWindowVisible(handle);
+        return m_impl->Backend().IsWindowVisible(handle);
     }
 
     bool WindowManager::IsValidWindow(NativeHandle handle)
     {
-        return m_impl->impl->IsValidWindow(handle);
+        return m_impl->Backend().IsValidWindow(handle);
+    }
+
+    Result<WindowProperty> WindowManager::GetWindowProperty(NativeHandle handle, const std::string &atomName)
+    {
+        return std::move(m_impl->Backend().GetWindowProperties({handle}, atomName).front());
+    }
+
+    std::vector<Result<WindowProperty>> WindowManager::GetWindowProperties(const std::vector<NativeHandle> &handles,
+                                                                           const std::string &atomName)
+    {
+        return m_impl->Backend().GetWindowProperties(handles, atomName);
+    }
+
+    int WindowManager::WatchProperty(NativeHandle handle, const std::string &atomName,
+                                     PropertyChangeCallback callback)
+    {
+        return m_impl->Backend().WatchProperty(handle, atomName, std::move(callback));
+    }
+
+    bool WindowManager::UnwatchProperty(int watchId)
+    {
+        return m_impl->Backend().UnwatchProperty(watchId);
+    }
+
+    bool WindowManager::PollEvents()
+    {
+        return m_impl->Backend().PollEvents();
+    }
+
+    WindowId WindowManager::GetWindowId(NativeHandle handle)
+    {
+        return m_impl->Backend().GetWindowId(handle);
+    }
+
+    bool WindowManager::IsCurrentWindow(const WindowId &id)
+    {
+        return m_impl->Backend().IsCurrentWindow(id);
     }
 
     NativeHandle WindowManager::GetFocusedWindow()
     {
-        return m_impl->impl->GetFocusedWindow();
+        return m_impl->Backend().GetFocusedWindow();
     }
 
     Result<WindowInfo> WindowManager::GetFocusedWindowInfo()
     {
-        return m_impl->impl->GetFocusedWindowInfo();
+        return m_impl->Backend().GetFocusedWindowInfo();
+    }
+
+    Result<WindowInfo> WindowManager::GetFocusedWindowInfo(Deadline deadline)
+    {
+        return m_impl->Backend().GetFocusedWindowInfo(deadline);
+    }
+
+    int WindowManager::GetCurrentDesktop()
+    {
+        return m_impl->Backend().GetCurrentDesktop();
+    }
+
+    int WindowManager::GetDesktopCount()
+    {
+        return m_impl->Backend().GetDesktopCount();
+    }
+
+    std::vector<MonitorInfo> WindowManager::GetMonitors()
+    {
+        return m_impl->Backend().GetMonitors();
+    }
+
+    std::vector<WindowInfo> WindowManager::FindWindowsOnMonitor(int monitorIndex)
+    {
+        return m_impl->Backend().FindWindowsOnMonitor(monitorIndex);
+    }
+
+    std::vector<WindowResourceUsage> WindowManager::GetWindowResourceUsage()
+    {
+        return m_impl->Backend().GetWindowResourceUsage();
+    }
+
+    Result<ResourceUsage> WindowManager::GetWindowResourceUsage(NativeHandle handle)
+    {
+        return m_impl->Backend().GetWindowResourceUsage(handle);
+    }
+
+    std::vector<ResourceUsage> WindowManager::GetProcessUsageHistory(uint32_t processId)
+    {
+        return m_impl->Backend().GetProcessUsageHistory(processId);
     }
 
     ErrorCode WindowManager::CloseWindow(NativeHandle handle)
     {
-        return m_impl->impl->CloseWindow(handle);
+        return m_impl->Backend().CloseWindow(handle);
     }
 
     ErrorCode WindowManager::ForceCloseWindow(NativeHandle handle)
     {
-        return m_impl->impl->ForceCloseWindow(handle);
+        return m_impl->Backend().ForceCloseWindow(handle);
+    }
+
+    ErrorCode WindowManager::CloseWindow(const WindowId &id)
+    {
+        if (ErrorCode status = m_impl->Backend().CheckWindowId(id); status != ErrorCode::Success)
+        {
+            return status;
+        }
+        return m_impl->Backend().CloseWindow(id.handle);
+    }
+
+    ErrorCode WindowManager::ForceCloseWindow(const WindowId &id)
+    {
+        if (ErrorCode status = m_impl->Backend().CheckWindowId(id); status != ErrorCode::Success)
+        {
+            return status;
+        }
+        return m_impl->Backend().ForceCloseWindow(id.handle);
+    }
+
+    ErrorCode WindowManager::CloseProcessTreeWindows(uint32_t rootProcessId)
+    {
+        return m_impl->Backend().CloseProcessTreeWindows(rootProcessId);
     }
 
     ErrorCode WindowManager::MinimizeWindow(NativeHandle handle)
     {
-        return m_impl->impl->MinimizeWindow(handle);
+        return m_impl->Backend().MinimizeWindow(handle);
     }
 
     ErrorCode WindowManager::MaximizeWindow(NativeHandle handle)
     {
-        return m_impl->impl->MaximizeWindow(handle);
+        return m_impl->Backend().MaximizeWindow(handle);
     }
 
     ErrorCode WindowManager::RestoreWindow(NativeHandle handle)
     {
-        return m_impl->impl->RestoreWindow(handle);
+        return m_impl->Backend().RestoreWindow(handle);
     }
 
     ErrorCode WindowManager::ShowWindow(NativeHandle handle)
     {
-        return m_impl->impl->ShowWindow(handle);
+        return m_impl->Backend().ShowWindow(handle);
     }
 
     ErrorCode WindowManager::HideWindow(NativeHandle handle)
     {
-        return m_impl->impl->HideWindow(handle);
+        return m_impl->Backend().HideWindow(handle);
     }
 
     ErrorCode WindowManager::FocusWindow(NativeHandle handle)
     {
-        return m_impl->impl->FocusWindow(handle);
+        return m_impl->Backend().FocusWindow(handle);
+    }
+
+    ErrorCode WindowManager::FocusWindow(const WindowId &id)
+    {
+        if (ErrorCode status = m_impl->Backend().CheckWindowId(id); status != ErrorCode::Success)
+        {
+            return status;
+        }
+        return m_impl->Backend().FocusWindow(id.handle);
     }
 
     ErrorCode WindowManager::SetAlwaysOnTop(NativeHandle handle, bool topmost)
     {
-        return m_impl->impl->SetAlwaysOnTop(handle, topmost);
+        return m_impl->Backend().SetAlwaysOnTop(handle, topmost);
     }
 
     ErrorCode WindowManager::SetWindowRect(NativeHandle handle, const Rect &rect)
     {
-        return m_impl->impl->SetWindowRect(handle, rect);
+        return m_impl->Backend().SetWindowRect(handle, rect);
     }
 
     ErrorCode WindowManager::MoveWindow(NativeHandle handle, int x, int y)
     {
-        return m_impl->impl->MoveWindow(handle, x, y);
+        return m_impl->Backend().MoveWindow(handle, x, y);
     }
 
     ErrorCode WindowManager::ResizeWindow(NativeHandle handle, int width, int height)
     {
-        return m_impl->impl->ResizeWindow(handle, width, height);
+        return m_impl->Backend().ResizeWindow(handle, width, height);
     }
 
     ErrorCode WindowManager::SetWindowTitle(NativeHandle handle, const std::string &title)
     {
-        return m_impl->impl->SetWindowTitle(handle, title);
+        return m_impl->Backend().SetWindowTitle(handle, title);
     }
 
     ErrorCode WindowManager::SetWindowOpacity(NativeHandle handle, float opacity)
     {
-        return m_impl->impl->SetWindowOpacity(handle, opacity);
+        return m_impl->Backend().SetWindowOpacity(handle, opacity);
     }
 
     std::string WindowManager::GetLastError() const
     {
-        return m_impl->impl->GetLastError();
+        return m_impl->Backend().GetLastError();
+    }
+
+    void WindowManager::SetPropertyLimits(const PropertyLimits &limits)
+    {
+        m_impl->Backend().SetPropertyLimits(limits);
+    }
+
+    PropertyLimits WindowManager::GetPropertyLimits() const
+    {
+        return m_impl->Backend().GetPropertyLimits();
+    }
+
+    EnumerationStrategy WindowManager::GetLastEnumerationStrategy() const
+    {
+        return m_impl->Backend().GetLastEnumerationStrategy();
+    }
+
+    bool WindowManager::WasLastEnumerationPartial() const
+    {
+        return m_impl->Backend().WasLastEnumerationPartial();
     }
 
     const char *WindowManager::GetPlatformName()
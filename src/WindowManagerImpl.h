@@ -19,15 +19,73 @@ namespace CrossWindow
         virtual ~WindowManagerImplBase() = default;
 
         virtual bool Initialize() = 0;
+        virtual bool Initialize(const std::string &displayName)
+        {
+            if (!displayName.empty())
+            {
+                SetLastError("Display names are not supported on this platform"_msg);
+                return false;
+            }
+            return Initialize();
+        }
+        virtual bool Initialize(const ExternalConnection &)
+        {
+            SetLastError("Adopting a connection is not supported on this platform"_msg);
+            return false;
+        }
+        virtual bool ProcessEvent(const void *) { return false; }
+        virtual bool ProcessXEvent(const void *) { return false; }
         virtual bool IsInitialized() const = 0;
+        virtual bool IsConnected() const { return IsInitialized(); }
         virtual void Shutdown() = 0;
 
         // Enumeration
         virtual std::vector<WindowInfo> GetAllWindows() = 0;
-        virtual void EnumerateWindows(const EnumWindowsCallback &callback) = 0;
+        virtual std::vector<WindowInfo> GetAllWindows(const EnumerationOptions &) { return GetAllWindows(); }
+        virtual void EnumerateWindows(WindowCallbackRef callback) = 0;
+        virtual void EnumerateWindows(WindowCallbackRef callback, const EnumerationOptions &)
+        {
+            EnumerateWindows(callback);
+        }
+        virtual void EnumerateWindowBatches(WindowBatchCallbackRef callback, const EnumerationOptions &options)
+        {
+            // Copies each window once; backends that own their WindowInfo can move it instead
+            const size_t batchSize = std::max(1u, options.batchSize);
+            std::vector<WindowInfo> batch;
+            batch.reserve(batchSize);
+            bool stopped = false;
+            auto collect = [&](const WindowInfo &info)
+            {
+                batch.push_back(info);
+                if (batch.size() < batchSize)
+                {
+                    return true;
+                }
+                stopped = !callback(batch.data(), batch.size());
+                batch.clear();
+                return !stopped;
+            };
+            EnumerateWindows(collect, options);
+            if (!stopped && !batch.empty())
+            {
+                callback(batch.data(), batch.size());
+            }
+        }
         virtual std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern,
                                                            bool caseSensitive) = 0;
         virtual std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName) = 0;
+        virtual std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern, bool caseSensitive,
+                                                           Deadline)
+        {
+            return FindWindowsByTitle(titlePattern, caseSensitive);
+        }
+        virtual std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName, Deadline)
+        {
+            return FindWindowsByProcess(processName);
+        }
+        virtual std::vector<WindowInfo> FindWindowsByCgroup(const std::string &) { return {}; }
+        virtual std::vector<ApplicationGroup> GroupWindowsByApplication() { return {}; }
+        virtual std::vector<WindowInfo> FindWindowsByProcessTree(uint32_t) { return {}; }
 
         // Information
         virtual Result<WindowInfo> GetWindowInfo(NativeHandle handle) = 0;
@@ -35,16 +93,79 @@ namespace CrossWindow
         virtual Result<Rect> GetWindowRect(NativeHandle handle) = 0;
         virtual Result<WindowState> GetWindowState(NativeHandle handle) = 0;
         virtual Result<uint32_t> GetWindowProcessId(NativeHandle handle) = 0;
+
+        // Deadline-bounded information; backends that cannot time out ignore the deadline
+        virtual Result<WindowInfo> GetWindowInfo(NativeHandle handle, Deadline) { return GetWindowInfo(handle); }
+        virtual Result<std::string> GetWindowTitle(NativeHandle handle, Deadline) { return GetWindowTitle(handle); }
+        virtual Result<Rect> GetWindowRect(NativeHandle handle, Deadline) { return GetWindowRect(handle); }
+        virtual Result<WindowState> GetWindowState(NativeHandle handle, Deadline) { return GetWindowState(handle); }
+        virtual Result<uint32_t> GetWindowProcessId(NativeHandle handle, Deadline) { return GetWindowProcessId(handle); }
+
         virtual bool IsWindowVisible(NativeHandle handle) = 0;
         virtual bool IsValidWindow(NativeHandle handle) = 0;
 
+        // Window properties
+        virtual std::vector<Result<WindowProperty>> GetWindowProperties(const std::vector<NativeHandle> &handles,
+                                                                        const std::string &)
+        {
+            Result<WindowProperty> unsupported;
+            unsupported.error = ErrorCode::NotSupported;
+            unsupported.errorMessage = "Window properties are not supported on this platform"_msg;
+            return std::vector<Result<WindowProperty>>(handles.size(), unsupported);
+        }
+        virtual int WatchProperty(NativeHandle, const std::string &, PropertyChangeCallback)
+        {
+            SetLastError("Window properties are not supported on this platform"_msg);
+            return 0;
+        }
+        virtual bool UnwatchProperty(int) { return false; }
+        virtual bool PollEvents() { return false; }
+
+        // Window ids; backends without generations accept any id whose handle is valid
+        virtual WindowId GetWindowId(NativeHandle handle) { return WindowId{handle, 0}; }
+        virtual bool IsCurrentWindow(const WindowId &id) { return IsValidWindow(id.handle); }
+        virtual ErrorCode CheckWindowId(const WindowId &id)
+        {
+            if (!IsInitialized())
+            {
+                return ErrorCode::NotInitialized;
+            }
+            if (!IsCurrentWindow(id))
+            {
+                SetLastError("Window id is stale"_msg);
+                return ErrorCode::WindowNotFound;
+            }
+            return ErrorCode::Success;
+        }
+
         // Active window
         virtual NativeHandle GetFocusedWindow() = 0;
         virtual Result<WindowInfo> GetFocusedWindowInfo() = 0;
+        virtual Result<WindowInfo> GetFocusedWindowInfo(Deadline) { return GetFocusedWindowInfo(); }
+
+        // Virtual desktops
+        virtual int GetCurrentDesktop() { return -1; }
+        virtual int GetDesktopCount() { return 0; }
+
+        // Monitors
+        virtual std::vector<MonitorInfo> GetMonitors() { return {}; }
+        virtual std::vector<WindowInfo> FindWindowsOnMonitor(int) { return {}; }
+
+        // Process resources
+        virtual std::vector<WindowResourceUsage> GetWindowResourceUsage() { return {}; }
+        virtual Result<ResourceUsage> GetWindowResourceUsage(NativeHandle)
+        {
+            Result<ResourceUsage> result;
+            result.error = ErrorCode::NotSupported;
+            result.errorMessage = "Resource usage is not supported on this platform"_msg;
+            return result;
+        }
+        virtual std::vector<ResourceUsage> GetProcessUsageHistory(uint32_t) { return {}; }
 
         // Manipulation
         virtual ErrorCode CloseWindow(NativeHandle handle) = 0;
         virtual ErrorCode ForceCloseWindow(NativeHandle handle) = 0;
+        virtual ErrorCode CloseProcessTreeWindows(uint32_t) { return ErrorCode::NotSupported; }
         virtual ErrorCode MinimizeWindow(NativeHandle handle) = 0;
         virtual ErrorCode MaximizeWindow(NativeHandle handle) = 0;
         virtual ErrorCode RestoreWindow(NativeHandle handle) = 0;
@@ -59,12 +180,21 @@ namespace CrossWindow
         virtual ErrorCode SetWindowOpacity(NativeHandle handle, float opacity) = 0;
 
         // Error handling
-        virtual std::string GetLastError() const = 0;
-        virtual void SetLastError(const std::string &error) = 0;
+        virtual ErrorMessage GetLastError() const = 0;
+        virtual void SetLastError(ErrorMessage error) = 0;
+
+        // Property size caps
+        virtual void SetPropertyLimits(const PropertyLimits &limits) { m_propertyLimits = limits; }
+        PropertyLimits GetPropertyLimits() const { return m_propertyLimits; }
+
+        // Diagnostics
+        virtual EnumerationStrategy GetLastEnumerationStrategy() const { return EnumerationStrategy::Native; }
+        virtual bool WasLastEnumerationPartial() const { return false; }
 
     protected:
         bool m_initialized = false;
-        std::string m_lastError;
+        ErrorMessage m_lastError;
+        PropertyLimits m_propertyLimits;
     };
 
 } // namespace CrossWindow
@@ -0,0 +1,183 @@
+/**
+ * @file WindowTable.cpp
+ * @brief Column-oriented window storage and its filters
+ *
+ * The filters first fill a byte mask in a loop without branches or calls, which
+ * the compiler can vectorize, and then collect the set rows in a second pass.
+ */
+
+#include "CrossWindow.h"
+
+namespace CrossWindow
+{
+
+    namespace
+    {
+        std::vector<uint32_t> CollectRows(const std::vector<uint8_t> &mask)
+        {
+            std::vector<uint32_t> rows;
+            for (size_t i = 0; i < mask.size(); ++i)
+            {
+                if (mask[i])
+                {
+                    rows.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            return rows;
+        }
+    } // namespace
+
+    void WindowTable::reserve(size_t rows)
+    {
+        handles.reserve(rows);
+        x.reserve(rows);
+        y.reserve(rows);
+        width.reserve(rows);
+        height.reserve(rows);
+        states.reserve(rows);
+        types.reserve(rows);
+        processIds.reserve(rows);
+        desktops.reserve(rows);
+        monitors.reserve(rows);
+        generations.reserve(rows);
+        classNameIds.reserve(rows);
+        processNameIds.reserve(rows);
+        visible.reserve(rows);
+        titleTruncated.reserve(rows);
+        skipTaskbar.reserve(rows);
+        skipPager.reserve(rows);
+        titles.reserve(rows);
+        classNames.reserve(rows);
+        processNames.reserve(rows);
+        cgroupPaths.reserve(rows);
+        cgroupUnits.reserve(rows);
+        containerIds.reserve(rows);
+    }
+
+    void WindowTable::clear()
+    {
+        *this = WindowTable();
+    }
+
+    WindowTable::StringRef WindowTable::Intern(const std::string &value)
+    {
+        StringRef ref;
+        if (value.empty())
+        {
+            return ref;
+        }
+
+        ref.offset = static_cast<uint32_t>(strings.size());
+        ref.length = static_cast<uint32_t>(value.size());
+        strings += value;
+        return ref;
+    }
+
+    void WindowTable::Append(const WindowInfo &info)
+    {
+        handles.push_back(info.handle);
+        x.push_back(info.rect.x);
+        y.push_back(info.rect.y);
+        width.push_back(info.rect.width);
+        height.push_back(info.rect.height);
+        states.push_back(info.state);
+        types.push_back(info.type);
+        processIds.push_back(info.processId);
+        desktops.push_back(info.desktop);
+        monitors.push_back(info.monitor);
+        generations.push_back(info.generation);
+        classNameIds.push_back(info.classNameId);
+        processNameIds.push_back(info.processNameId);
+        visible.push_back(info.isVisible ? 1 : 0);
+        titleTruncated.push_back(info.titleTruncated ? 1 : 0);
+        skipTaskbar.push_back(info.skipTaskbar ? 1 : 0);
+        skipPager.push_back(info.skipPager ? 1 : 0);
+        titles.push_back(Intern(info.title));
+        classNames.push_back(Intern(info.className));
+        processNames.push_back(Intern(info.processName));
+        cgroupPaths.push_back(Intern(info.cgroupPath));
+        cgroupUnits.push_back(Intern(info.cgroupUnit));
+        containerIds.push_back(Intern(info.containerId));
+    }
+
+    WindowInfo WindowTable::Row(size_t row) const
+    {
+        WindowInfo info;
+        info.handle = handles[row];
+        info.rect = Rect{x[row], y[row], width[row], height[row]};
+        info.state = states[row];
+        info.type = types[row];
+        info.processId = processIds[row];
+        info.desktop = desktops[row];
+        info.monitor = monitors[row];
+        info.generation = generations[row];
+        info.classNameId = classNameIds[row];
+        info.processNameId = processNameIds[row];
+        info.isVisible = visible[row] != 0;
+        info.titleTruncated = titleTruncated[row] != 0;
+        info.skipTaskbar = skipTaskbar[row] != 0;
+        info.skipPager = skipPager[row] != 0;
+        info.title = std::string(String(titles[row]));
+        info.className = std::string(String(classNames[row]));
+        info.processName = std::string(String(processNames[row]));
+        info.cgroupPath = std::string(String(cgroupPaths[row]));
+        info.cgroupUnit = std::string(String(cgroupUnits[row]));
+        info.containerId = std::string(String(containerIds[row]));
+        return info;
+    }
+
+    std::vector<uint32_t> WindowTable::WithState(WindowState flags) const
+    {
+        const uint32_t wanted = static_cast<uint32_t>(flags);
+        const WindowState *state = states.data();
+        std::vector<uint8_t> mask(size());
+        for (size_t i = 0; i < mask.size(); ++i)
+        {
+            mask[i] = (static_cast<uint32_t>(state[i]) & wanted) == wanted;
+        }
+        return CollectRows(mask);
+    }
+
+    std::vector<uint32_t> WindowTable::WithoutState(WindowState flags) const
+    {
+        const uint32_t unwanted = static_cast<uint32_t>(flags);
+        const WindowState *state = states.data();
+        std::vector<uint8_t> mask(size());
+        for (size_t i = 0; i < mask.size(); ++i)
+        {
+            mask[i] = (static_cast<uint32_t>(state[i]) & unwanted) == 0;
+        }
+        return CollectRows(mask);
+    }
+
+    std::vector<uint32_t> WindowTable::Intersecting(const Rect &area) const
+    {
+        if (area.width <= 0 || area.height <= 0)
+        {
+            return {};
+        }
+
+        const int left = area.x;
+        const int top = area.y;
+        const int right = area.x + area.width;
+        const int bottom = area.y + area.height;
+        const int *px = x.data();
+        const int *py = y.data();
+        const int *pw = width.data();
+        const int *ph = height.data();
+        std::vector<uint8_t> mask(size());
+        for (size_t i = 0; i < mask.size(); ++i)
+        {
+            // Bitwise & keeps the loop free of branches
+            mask[i] = (pw[i] > 0) & (ph[i] > 0) & (px[i] < right) & (px[i] + pw[i] > left) &
+                      (py[i] < bottom) & (py[i] + ph[i] > top);
+        }
+        return CollectRows(mask);
+    }
+
+    std::vector<uint32_t> WindowTable::Visible() const
+    {
+        return CollectRows(visible);
+    }
+
+} // namespace CrossWindow
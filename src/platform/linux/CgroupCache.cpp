@@ -0,0 +1,210 @@
+/**
+ * @file CgroupCache.cpp
+ * @brief Process-to-cgroup attribution for the Linux backend
+ */
+
+#include "CgroupCache.h"
+#include "ProcReader.h"
+#include <cctype>
+#include <iterator>
+#include <unordered_set>
+
+namespace CrossWindow
+{
+
+    namespace
+    {
+        bool EndsWith(const std::string &text, size_t end, const char *suffix, size_t length)
+        {
+            return end >= length && text.compare(end - length, length, suffix) == 0;
+        }
+    } // namespace
+
+    CgroupInfo DescribeCgroup(const std::string &path)
+    {
+        CgroupInfo info;
+        info.path = path;
+
+        // Walk the components; the innermost unit wins
+        size_t begin = 0;
+        while (begin < path.size())
+        {
+            size_t end = path.find('/', begin);
+            if (end == std::string::npos)
+            {
+                end = path.size();
+            }
+
+            if (EndsWith(path, end, ".service", 8) || EndsWith(path, end, ".scope", 6))
+            {
+                info.unit = path.substr(begin, end - begin);
+            }
+            begin = end + 1;
+        }
+
+        // Docker, podman and containerd all embed the 64-hex id somewhere in the path
+        size_t run = 0;
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            if (std::isxdigit(static_cast<unsigned char>(path[i])) &&
+                !std::isupper(static_cast<unsigned char>(path[i])))
+            {
+                if (++run == 64 && (i + 1 == path.size() || !std::isxdigit(static_cast<unsigned char>(path[i + 1]))))
+                {
+                    info.containerId = path.substr(i + 1 - 64, 64);
+                    break;
+                }
+            }
+            else
+            {
+                run = 0;
+            }
+        }
+
+        return info;
+    }
+
+    std::string SelectCgroupPath(const std::string &procCgroup)
+    {
+        // Lines are "hierarchy-id:controllers:path". Prefer the unified hierarchy
+        // ("0::"), then the systemd named hierarchy on v1-only hosts.
+        std::string systemd;
+        std::string first;
+        size_t begin = 0;
+        while (begin < procCgroup.size())
+        {
+            size_t end = procCgroup.find('\n', begin);
+            if (end == std::string::npos)
+            {
+                end = procCgroup.size();
+            }
+
+            size_t colon1 = procCgroup.find(':', begin);
+            size_t colon2 = colon1 < end ? procCgroup.find(':', colon1 + 1) : std::string::npos;
+            if (colon2 < end)
+            {
+                std::string controllers = procCgroup.substr(colon1 + 1, colon2 - colon1 - 1);
+                std::string path = procCgroup.substr(colon2 + 1, end - colon2 - 1);
+                if (colon1 == begin + 1 && procCgroup[begin] == '0' && controllers.empty())
+                {
+                    return path;
+                }
+                if (controllers == "name=systemd")
+                {
+                    systemd = path;
+                }
+                else if (first.empty())
+                {
+                    first = path;
+                }
+            }
+            begin = end + 1;
+        }
+        return !systemd.empty() ? systemd : first;
+    }
+
+    void CgroupCache::Refresh(const std::vector<uint32_t> &pids, Proc::BatchReader &reader)
+    {
+        std::unordered_set<uint32_t> seen;
+        std::vector<uint32_t> distinct;
+        seen.reserve(pids.size());
+        for (uint32_t pid : pids)
+        {
+            if (pid != 0 && seen.insert(pid).second)
+            {
+                distinct.push_back(pid);
+            }
+        }
+
+        std::vector<std::string> stats(distinct.size());
+        std::vector<Proc::ReadRequest> requests(distinct.size());
+        for (size_t i = 0; i < distinct.size(); ++i)
+        {
+            requests[i] = {distinct[i], "stat", &stats[i]};
+        }
+        reader.Read(requests);
+
+        // Processes whose start time is unknown or changed need their cgroup read
+        std::vector<uint32_t> missing;
+        std::vector<uint64_t> startTimes;
+        for (size_t i = 0; i < distinct.size(); ++i)
+        {
+            Proc::StatFields stat;
+            if (!requests[i].ok || !Proc::ParseStat(stats[i], stat))
+            {
+                seen.erase(distinct[i]);
+                continue;
+            }
+            auto it = m_entries.find(distinct[i]);
+            if (it == m_entries.end() || it->second.startTime != stat.startTime)
+            {
+                missing.push_back(distinct[i]);
+                startTimes.push_back(stat.startTime);
+            }
+        }
+
+        std::vector<std::string> cgroups(missing.size());
+        requests.assign(missing.size(), Proc::ReadRequest{});
+        for (size_t i = 0; i < missing.size(); ++i)
+        {
+            requests[i] = {missing[i], "cgroup", &cgroups[i]};
+        }
+        reader.Read(requests);
+
+        for (size_t i = 0; i < missing.size(); ++i)
+        {
+            if (!requests[i].ok)
+            {
+                seen.erase(missing[i]);
+                continue;
+            }
+            Entry &entry = m_entries[missing[i]];
+            entry.startTime = startTimes[i];
+            entry.info = DescribeCgroup(SelectCgroupPath(cgroups[i]));
+        }
+
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            it = seen.count(it->first) ? std::next(it) : m_entries.erase(it);
+        }
+    }
+
+    const CgroupInfo *CgroupCache::Lookup(uint32_t pid)
+    {
+        Proc::StatFields stat;
+        if (pid == 0 || !Proc::ReadStat(pid, stat))
+        {
+            m_entries.erase(pid);
+            return nullptr;
+        }
+
+        auto it = m_entries.find(pid);
+        if (it != m_entries.end() && it->second.startTime == stat.startTime)
+        {
+            return &it->second.info;
+        }
+        return Load(pid, stat.startTime);
+    }
+
+    const CgroupInfo *CgroupCache::Find(uint32_t pid) const
+    {
+        auto it = m_entries.find(pid);
+        return it != m_entries.end() ? &it->second.info : nullptr;
+    }
+
+    const CgroupInfo *CgroupCache::Load(uint32_t pid, uint64_t startTime)
+    {
+        std::string text;
+        if (!Proc::ReadFile(pid, "cgroup", text))
+        {
+            m_entries.erase(pid);
+            return nullptr;
+        }
+
+        Entry &entry = m_entries[pid];
+        entry.startTime = startTime;
+        entry.info = DescribeCgroup(SelectCgroupPath(text));
+        return &entry.info;
+    }
+
+} // namespace CrossWindow
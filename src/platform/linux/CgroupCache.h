@@ -0,0 +1,79 @@
+/**
+ * @file CgroupCache.h
+ * @brief Process-to-cgroup attribution for the Linux backend
+ *
+ * The cgroup of a process is read from /proc/<pid>/cgroup once and cached
+ * under (pid, start time), so a reused PID is never attributed to the cgroup
+ * of the process that held it before.
+ */
+
+#pragma once
+
+#include "ProcBatchReader.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CrossWindow
+{
+
+    /**
+     * @brief Where a process sits in the cgroup hierarchy
+     */
+    struct CgroupInfo
+    {
+        std::string path;        ///< Unified (v2) path, or the systemd v1 path
+        std::string unit;        ///< Innermost systemd .service or .scope, if any
+        std::string containerId; ///< 64-hex container id embedded in the path, if any
+    };
+
+    /**
+     * @brief Derive unit and container id from a cgroup path
+     */
+    CgroupInfo DescribeCgroup(const std::string &path);
+
+    /**
+     * @brief Pick the relevant path out of the contents of /proc/<pid>/cgroup
+     */
+    std::string SelectCgroupPath(const std::string &procCgroup);
+
+    class CgroupCache
+    {
+    public:
+        /**
+         * @brief Bring the cache up to date for one enumeration pass
+         *
+         * Each distinct PID costs one stat read to confirm its start time; the
+         * cgroup file is read only for processes not seen before. Both rounds
+         * go through the batched reader. Entries for PIDs absent from the pass
+         * are dropped.
+         */
+        void Refresh(const std::vector<uint32_t> &pids, Proc::BatchReader &reader);
+
+        /**
+         * @brief Cgroup of a process, reading /proc only on a cache miss
+         * @return nullptr if the process does not exist
+         */
+        const CgroupInfo *Lookup(uint32_t pid);
+
+        /**
+         * @brief Cached cgroup of a process, without touching /proc
+         */
+        const CgroupInfo *Find(uint32_t pid) const;
+
+        void Clear() { m_entries.clear(); }
+
+    private:
+        struct Entry
+        {
+            uint64_t startTime = 0;
+            CgroupInfo info;
+        };
+
+        const CgroupInfo *Load(uint32_t pid, uint64_t startTime);
+
+        std::unordered_map<uint32_t, Entry> m_entries;
+    };
+
+} // namespace CrossWindow
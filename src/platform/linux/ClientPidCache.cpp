@@ -0,0 +1,294 @@
+/**
+ * @file ClientPidCache.cpp
+ * @brief Window-to-PID attribution through the X-Resource extension
+ */
+
+#include "ClientPidCache.h"
+#include <xcb/xcbext.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        namespace
+        {
+            // libxcb-res is not always installed, so the two requests used here are
+            // encoded by hand (see XResproto.h)
+            xcb_extension_t g_xresExtension = {"X-Resource", 0};
+
+            constexpr uint8_t kXResQueryVersion = 0;
+            constexpr uint8_t kXResQueryClientIds = 4;
+            constexpr uint32_t kClientIdPidMask = 1u << 1;
+
+            struct QueryVersionRequest
+            {
+                uint8_t majorOpcode;
+                uint8_t minorOpcode;
+                uint16_t length;
+                uint8_t clientMajor;
+                uint8_t clientMinor;
+                uint8_t pad[2];
+            };
+
+            struct QueryVersionReply
+            {
+                uint8_t responseType;
+                uint8_t pad0;
+                uint16_t sequence;
+                uint32_t length;
+                uint16_t serverMajor;
+                uint16_t serverMinor;
+            };
+
+            struct QueryClientIdsRequest
+            {
+                uint8_t majorOpcode;
+                uint8_t minorOpcode;
+                uint16_t length;
+                uint32_t numSpecs;
+            };
+
+            struct ClientIdSpec
+            {
+                uint32_t client;
+                uint32_t mask;
+            };
+
+            struct QueryClientIdsReply
+            {
+                uint8_t responseType;
+                uint8_t pad0;
+                uint16_t sequence;
+                uint32_t length;
+                uint32_t numIds;
+                uint8_t pad1[20];
+            };
+
+            struct ClientIdValueHeader
+            {
+                ClientIdSpec spec;
+                uint32_t length; // Bytes of value that follow
+            };
+
+            bool ProcessExists(uint32_t pid)
+            {
+                return access(("/proc/" + std::to_string(pid)).c_str(), F_OK) == 0;
+            }
+        } // namespace
+
+        bool ClientPidCache::Initialize(xcb_connection_t *conn)
+        {
+            ReplyWait wait;
+            return CompleteInitialize(conn, RequestVersion(conn), wait);
+        }
+
+        void ClientPidCache::Prefetch(xcb_connection_t *conn)
+        {
+            xcb_prefetch_extension_data(conn, &g_xresExtension);
+        }
+
+        unsigned int ClientPidCache::RequestVersion(xcb_connection_t *conn)
+        {
+            Reset();
+
+            const xcb_query_extension_reply_t *ext = xcb_get_extension_data(conn, &g_xresExtension);
+            if (!ext || !ext->present)
+            {
+                return 0;
+            }
+
+            // QueryClientIds needs protocol 1.2
+            QueryVersionRequest request{};
+            request.clientMajor = 1;
+            request.clientMinor = 2;
+
+            static const xcb_protocol_request_t protocol = {1, &g_xresExtension, kXResQueryVersion, 0};
+            struct iovec parts[3];
+            parts[2].iov_base = &request;
+            parts[2].iov_len = sizeof(request);
+            return xcb_send_request(conn, XCB_REQUEST_CHECKED, parts + 2, &protocol);
+        }
+
+        bool ClientPidCache::CompleteInitialize(xcb_connection_t *conn, unsigned int sequence, ReplyWait &wait)
+        {
+            if (sequence == 0)
+            {
+                return false;
+            }
+
+            Reply<QueryVersionReply> reply(static_cast<QueryVersionReply *>(WaitForReply(conn, sequence, wait)));
+            if (!reply || reply->serverMajor < 1 || (reply->serverMajor == 1 && reply->serverMinor < 2))
+            {
+                return false;
+            }
+
+            m_resourceMask = xcb_get_setup(conn)->resource_id_mask;
+            m_available = true;
+            return true;
+        }
+
+        void ClientPidCache::Reset()
+        {
+            m_available = false;
+            m_resourceMask = 0;
+            m_pids.clear();
+        }
+
+        ClientPidCache::Pending ClientPidCache::Request(xcb_connection_t *conn, const xcb_window_t *windows,
+                                                       size_t count)
+        {
+            Pending pending;
+            if (!m_available)
+            {
+                return pending;
+            }
+
+            std::vector<ClientIdSpec> specs;
+            std::unordered_set<uint32_t> seen;
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t client = ClientOf(windows[i]);
+                if (!seen.insert(client).second)
+                {
+                    continue;
+                }
+
+                auto it = m_pids.find(client);
+                if (it != m_pids.end() && (it->second.pid == 0 || ProcessExists(it->second.pid)))
+                {
+                    continue;
+                }
+
+                // Any XID owned by the client identifies it; use the window itself
+                specs.push_back({windows[i], kClientIdPidMask});
+                pending.clients.push_back(client);
+                pending.witnesses.push_back(windows[i]);
+            }
+
+            if (specs.empty())
+            {
+                return pending;
+            }
+
+            QueryClientIdsRequest request{};
+            request.numSpecs = static_cast<uint32_t>(specs.size());
+
+            static const xcb_protocol_request_t protocol = {2, &g_xresExtension, kXResQueryClientIds, 0};
+            struct iovec parts[4];
+            parts[2].iov_base = &request;
+            parts[2].iov_len = sizeof(request);
+            parts[3].iov_base = specs.data();
+            parts[3].iov_len = specs.size() * sizeof(ClientIdSpec);
+            pending.sequence = xcb_send_request(conn, XCB_REQUEST_CHECKED, parts + 2, &protocol);
+            return pending;
+        }
+
+        void ClientPidCache::Collect(xcb_connection_t *conn, Pending &pending, ReplyWait &wait)
+        {
+            if (pending.clients.empty())
+            {
+                return;
+            }
+
+            Reply<QueryClientIdsReply> reply(
+                static_cast<QueryClientIdsReply *>(WaitForReply(conn, pending.sequence, wait)));
+            if (!reply)
+            {
+                pending.clients.clear();
+                pending.witnesses.clear();
+                return;
+            }
+
+            // Clients the server has no PID for (e.g. remote) are cached as 0 so they
+            // are not asked about again until the next full pass
+            for (size_t i = 0; i < pending.clients.size(); ++i)
+            {
+                m_pids[pending.clients[i]] = Entry{0, pending.witnesses[i]};
+            }
+
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(reply.get()) + sizeof(QueryClientIdsReply);
+            const uint8_t *end = reinterpret_cast<const uint8_t *>(reply.get()) +
+                                 sizeof(QueryClientIdsReply) + static_cast<size_t>(reply->length) * 4;
+            for (uint32_t i = 0; i < reply->numIds && data + sizeof(ClientIdValueHeader) <= end; ++i)
+            {
+                ClientIdValueHeader header;
+                std::memcpy(&header, data, sizeof(header));
+                data += sizeof(header);
+                if (data + header.length > end)
+                {
+                    break;
+                }
+
+                if ((header.spec.mask & kClientIdPidMask) && header.length == 4)
+                {
+                    uint32_t pid;
+                    std::memcpy(&pid, data, sizeof(pid));
+                    m_pids[ClientOf(header.spec.client)].pid = pid;
+                }
+                data += header.length;
+            }
+
+            pending.clients.clear();
+            pending.witnesses.clear();
+        }
+
+        void ClientPidCache::Discard(xcb_connection_t *conn, Pending &pending)
+        {
+            if (!pending.clients.empty())
+            {
+                xcb_discard_reply(conn, pending.sequence);
+                pending.clients.clear();
+                pending.witnesses.clear();
+            }
+        }
+
+        uint32_t ClientPidCache::Lookup(xcb_window_t window) const
+        {
+            auto it = m_pids.find(ClientOf(window));
+            return it != m_pids.end() ? it->second.pid : 0;
+        }
+
+        bool ClientPidCache::IsCached(xcb_window_t window) const
+        {
+            auto it = m_pids.find(ClientOf(window));
+            return it != m_pids.end() && (it->second.pid == 0 || ProcessExists(it->second.pid));
+        }
+
+        void ClientPidCache::Retain(const xcb_window_t *windows, size_t count)
+        {
+            if (m_pids.empty())
+            {
+                return;
+            }
+
+            std::unordered_set<xcb_window_t> listed(windows, windows + count);
+            for (auto it = m_pids.begin(); it != m_pids.end();)
+            {
+                if (it->second.pid == 0 || !listed.count(it->second.witness))
+                {
+                    it = m_pids.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        void ClientPidCache::WindowDestroyed(xcb_window_t window)
+        {
+            auto it = m_pids.find(ClientOf(window));
+            if (it != m_pids.end() && it->second.witness == window)
+            {
+                m_pids.erase(it);
+            }
+        }
+
+    } // namespace Xcb
+} // namespace CrossWindow
@@ -0,0 +1,126 @@
+/**
+ * @file ClientPidCache.h
+ * @brief Window-to-PID attribution through the X-Resource extension
+ *
+ * Not every client sets _NET_WM_PID (remote, sandboxed and some toolkit
+ * windows do not). X-Resource 1.2 lets the server report the PID of the
+ * client that owns any resource. All clients of a pass are resolved with a
+ * single QueryClientIds request, and the answers are cached per client.
+ *
+ * The server hands a disconnected client's id to the next client, so an
+ * entry only lasts while the window it was asked about (its witness) lives:
+ * it is dropped on the witness's DestroyNotify, and on every full pass that
+ * no longer lists the witness. Clients without a PID are asked again on
+ * every full pass.
+ */
+
+#pragma once
+
+#include "XcbPipeline.h"
+#include <unordered_map>
+#include <vector>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        /**
+         * @brief Caches the PID of X clients, keyed by client resource base
+         */
+        class ClientPidCache
+        {
+        public:
+            /**
+             * @brief An outstanding QueryClientIds request
+             */
+            struct Pending
+            {
+                unsigned int sequence = 0;
+                std::vector<uint32_t> clients;       ///< Client ids asked for
+                std::vector<xcb_window_t> witnesses; ///< Window each client was asked about
+            };
+
+            /**
+             * @brief Check for X-Resource 1.2 on the connection
+             * @return true if PIDs can be queried
+             */
+            bool Initialize(xcb_connection_t *conn);
+
+            /**
+             * @brief Ask for the extension data without waiting for it
+             */
+            static void Prefetch(xcb_connection_t *conn);
+
+            /**
+             * @brief First half of Initialize: send QueryVersion without waiting
+             * @return Sequence of the request, or 0 if X-Resource is absent
+             */
+            unsigned int RequestVersion(xcb_connection_t *conn);
+
+            /**
+             * @brief Second half of Initialize: wait for the QueryVersion reply
+             */
+            bool CompleteInitialize(xcb_connection_t *conn, unsigned int sequence, ReplyWait &wait);
+
+            void Reset();
+
+            bool IsAvailable() const { return m_available; }
+
+            /**
+             * @brief Send one request covering every uncached client owning the windows
+             *
+             * Does not wait for the reply. Cached entries whose process has exited
+             * are queried again.
+             */
+            Pending Request(xcb_connection_t *conn, const xcb_window_t *windows, size_t count);
+
+            /**
+             * @brief Wait for the reply of Request and store the PIDs it carries
+             */
+            void Collect(xcb_connection_t *conn, Pending &pending, ReplyWait &wait);
+
+            /**
+             * @brief Drop the reply of Request without waiting for it
+             */
+            void Discard(xcb_connection_t *conn, Pending &pending);
+
+            /**
+             * @brief Cached PID of the client owning a window
+             * @return The PID, or 0 if unknown
+             */
+            uint32_t Lookup(xcb_window_t window) const;
+
+            /**
+             * @brief Whether Request would skip the client owning a window
+             */
+            bool IsCached(xcb_window_t window) const;
+
+            /**
+             * @brief Keep only the clients whose witness is among a complete window list
+             *
+             * Also drops clients cached without a PID, so the next Request asks again.
+             */
+            void Retain(const xcb_window_t *windows, size_t count);
+
+            /**
+             * @brief Drop the client a destroyed window was the witness of
+             */
+            void WindowDestroyed(xcb_window_t window);
+
+        private:
+            uint32_t ClientOf(xcb_window_t window) const { return window & ~m_resourceMask; }
+
+            bool m_available = false;
+            uint32_t m_resourceMask = 0;
+            struct Entry
+            {
+                uint32_t pid = 0; ///< 0 = server does not know
+                xcb_window_t witness = XCB_NONE;
+            };
+
+            std::unordered_map<uint32_t, Entry> m_pids; ///< Client id -> PID
+        };
+
+    } // namespace Xcb
+} // namespace CrossWindow
@@ -0,0 +1,391 @@
+/**
+ * @file ProcBatchReader.cpp
+ * @brief Batched reads of many /proc files
+ */
+
+#include "ProcBatchReader.h"
+#include "ProcReader.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#ifdef CROSSWINDOW_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <cstring>
+#include <initializer_list>
+#endif
+
+namespace CrossWindow
+{
+    namespace Proc
+    {
+
+#ifdef CROSSWINDOW_HAVE_IO_URING
+        namespace
+        {
+            // Each file takes two entries (open, then read linked to close)
+            constexpr unsigned kRingEntries = 256;
+            constexpr size_t kBatchFiles = kRingEntries / 2;
+
+            // Large enough for stat, statm, comm and cgroup; longer files are finished
+            // with plain reads
+            constexpr size_t kFileBuffer = 4096;
+
+            // user_data layout: file index in the low bits, operation in the top byte
+            constexpr uint64_t kOpRead = 1ull << 56;
+            constexpr uint64_t kOpClose = 2ull << 56;
+            constexpr uint64_t kIndexMask = (1ull << 56) - 1;
+        } // namespace
+
+        /**
+         * @brief Minimal io_uring without liburing: one SQ/CQ pair, raw syscalls
+         */
+        struct BatchReader::Ring
+        {
+            int fd = -1;
+            void *sqRing = MAP_FAILED;
+            size_t sqRingSize = 0;
+            void *cqRing = MAP_FAILED;
+            size_t cqRingSize = 0;
+            io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+            size_t sqesSize = 0;
+
+            unsigned *sqHead = nullptr;
+            unsigned *sqTail = nullptr;
+            unsigned sqMask = 0;
+            unsigned *sqArray = nullptr;
+            unsigned *cqHead = nullptr;
+            unsigned *cqTail = nullptr;
+            unsigned cqMask = 0;
+            io_uring_cqe *cqes = nullptr;
+
+            unsigned localTail = 0;
+            unsigned queued = 0;
+
+            ~Ring()
+            {
+                if (sqes != MAP_FAILED)
+                    munmap(sqes, sqesSize);
+                if (cqRing != MAP_FAILED && cqRing != sqRing)
+                    munmap(cqRing, cqRingSize);
+                if (sqRing != MAP_FAILED)
+                    munmap(sqRing, sqRingSize);
+                if (fd >= 0)
+                    close(fd);
+            }
+
+            bool Init()
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                fd = static_cast<int>(syscall(__NR_io_uring_setup, kRingEntries, &params));
+                if (fd < 0)
+                {
+                    return false;
+                }
+
+                sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single)
+                {
+                    sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+                }
+
+                sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              fd, IORING_OFF_SQ_RING);
+                if (sqRing == MAP_FAILED)
+                {
+                    return false;
+                }
+                cqRing = single ? sqRing
+                                : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                       fd, IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED)
+                {
+                    return false;
+                }
+                sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+                if (sqes == MAP_FAILED)
+                {
+                    return false;
+                }
+
+                char *sq = static_cast<char *>(sqRing);
+                sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+                sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+                sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+                sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+                char *cq = static_cast<char *>(cqRing);
+                cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+                cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+                cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+                cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+                localTail = *sqTail;
+
+                return Supports({IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE});
+            }
+
+            bool Supports(std::initializer_list<int> ops)
+            {
+                constexpr unsigned kProbeOps = 256;
+                std::vector<char> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+                auto *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+                if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+                {
+                    return false;
+                }
+                for (int op : ops)
+                {
+                    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            io_uring_sqe *Next()
+            {
+                unsigned index = localTail & sqMask;
+                io_uring_sqe *sqe = &sqes[index];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqArray[index] = index;
+                ++localTail;
+                ++queued;
+                return sqe;
+            }
+
+            // Submit everything queued and wait until all of it has completed. The
+            // completion queue is drained after every batch, so it starts out empty.
+            bool SubmitAndWait(size_t &syscalls)
+            {
+                __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+                unsigned toSubmit = queued;
+                unsigned expected = queued;
+                unsigned start = *cqHead;
+                queued = 0;
+                for (;;)
+                {
+                    unsigned ready = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) - start;
+                    if (toSubmit == 0 && ready >= expected)
+                    {
+                        return true;
+                    }
+                    unsigned wait = ready >= expected ? 0 : expected - ready;
+                    int ret = static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, wait,
+                                                       IORING_ENTER_GETEVENTS, nullptr, 0));
+                    ++syscalls;
+                    if (ret < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return false;
+                    }
+                    toSubmit -= static_cast<unsigned>(ret);
+                }
+            }
+
+            template <typename F>
+            void Reap(F &&onCompletion)
+            {
+                unsigned head = *cqHead;
+                unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe &cqe = cqes[head & cqMask];
+                    onCompletion(cqe.user_data, cqe.res);
+                }
+                __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            }
+        };
+#endif
+
+        BatchReader::BatchReader()
+        {
+#ifdef CROSSWINDOW_HAVE_IO_URING
+            m_ring.reset(new Ring());
+            if (!m_ring->Init())
+            {
+                // Old kernel, or io_uring blocked by seccomp/sysctl
+                m_ring.reset();
+            }
+            else
+            {
+                m_buffers.resize(kBatchFiles * kFileBuffer);
+            }
+#endif
+        }
+
+        BatchReader::~BatchReader() = default;
+
+        bool BatchReader::IsUsingIoUring() const
+        {
+#ifdef CROSSWINDOW_HAVE_IO_URING
+            return m_ring != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        void BatchReader::DisableIoUring()
+        {
+#ifdef CROSSWINDOW_HAVE_IO_URING
+            m_ring.reset();
+            m_buffers.clear();
+            m_buffers.shrink_to_fit();
+#endif
+        }
+
+        void BatchReader::Read(ReadRequest *requests, size_t count)
+        {
+            size_t done = 0;
+#ifdef CROSSWINDOW_HAVE_IO_URING
+            while (m_ring && done < count)
+            {
+                size_t batch = std::min(count - done, kBatchFiles);
+                if (!ReadBatch(requests + done, batch))
+                {
+                    // The ring is in an unknown state; finish with plain syscalls
+                    DisableIoUring();
+                    break;
+                }
+                done += batch;
+            }
+#endif
+            for (; done < count; ++done)
+            {
+                ReadPlain(requests[done]);
+            }
+        }
+
+        void BatchReader::ReadPlain(ReadRequest &request)
+        {
+            request.ok = ReadFile(request.pid, request.name, *request.out, &m_syscalls);
+        }
+
+#ifdef CROSSWINDOW_HAVE_IO_URING
+        void BatchReader::CloseAll(const int *fds, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (fds[i] >= 0)
+                {
+                    ::close(fds[i]);
+                    ++m_syscalls;
+                }
+            }
+        }
+
+        bool BatchReader::ReadBatch(ReadRequest *requests, size_t count)
+        {
+            char paths[kBatchFiles][64];
+            int fds[kBatchFiles];
+            int readBytes[kBatchFiles];
+
+            // Phase 1: all opens
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::snprintf(paths[i], sizeof(paths[i]), "/proc/%u/%s", requests[i].pid, requests[i].name);
+                io_uring_sqe *sqe = m_ring->Next();
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(paths[i]);
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                sqe->user_data = i;
+                fds[i] = -1;
+            }
+            bool submitted = m_ring->SubmitAndWait(m_syscalls);
+            m_ring->Reap([&](uint64_t data, int res)
+                         { fds[data & kIndexMask] = res; });
+            if (!submitted)
+            {
+                // Opens that completed before the failure still own their files
+                CloseAll(fds, count);
+                return false;
+            }
+
+            // Phase 2: every read, each linked to the close of its file
+            size_t opened = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                readBytes[i] = -1;
+                if (fds[i] < 0)
+                {
+                    requests[i].ok = false;
+                    continue;
+                }
+                io_uring_sqe *readSqe = m_ring->Next();
+                readSqe->opcode = IORING_OP_READ;
+                readSqe->fd = fds[i];
+                readSqe->addr = reinterpret_cast<uint64_t>(m_buffers.data() + i * kFileBuffer);
+                readSqe->len = kFileBuffer;
+                readSqe->off = 0;
+                // A short read counts as failure for a plain link and would cancel the
+                // close; a hard link runs the close regardless
+                readSqe->flags = IOSQE_IO_HARDLINK;
+                readSqe->user_data = kOpRead | i;
+
+                io_uring_sqe *closeSqe = m_ring->Next();
+                closeSqe->opcode = IORING_OP_CLOSE;
+                closeSqe->fd = fds[i];
+                closeSqe->user_data = kOpClose | i;
+                ++opened;
+            }
+            if (opened > 0)
+            {
+                bool submitted = m_ring->SubmitAndWait(m_syscalls);
+                m_ring->Reap([&](uint64_t data, int res)
+                             {
+                                 size_t i = data & kIndexMask;
+                                 if ((data & ~kIndexMask) == kOpRead)
+                                 {
+                                     readBytes[i] = res;
+                                     return;
+                                 }
+                                 if (res == -ECANCELED)
+                                 {
+                                     // Kernels without hard links cancel the close after a failed read
+                                     ::close(fds[i]);
+                                     ++m_syscalls;
+                                 }
+                                 fds[i] = -1; });
+                if (!submitted)
+                {
+                    // Close the files whose close never completed
+                    CloseAll(fds, count);
+                    return false;
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (readBytes[i] < 0)
+                {
+                    requests[i].ok = false;
+                }
+                else if (static_cast<size_t>(readBytes[i]) == kFileBuffer)
+                {
+                    // Did not fit; the file is closed already, so read it again from the start
+                    ReadPlain(requests[i]);
+                }
+                else
+                {
+                    requests[i].out->assign(m_buffers.data() + i * kFileBuffer, static_cast<size_t>(readBytes[i]));
+                    requests[i].ok = true;
+                }
+            }
+            return true;
+        }
+#endif
+
+    } // namespace Proc
+} // namespace CrossWindow
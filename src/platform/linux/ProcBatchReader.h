@@ -0,0 +1,84 @@
+/**
+ * @file ProcBatchReader.h
+ * @brief Batched reads of many /proc files
+ *
+ * A refresh reads several small files for every window-owning process, which
+ * is three or more syscalls per file. When io_uring is available the opens of
+ * a whole batch are submitted together, then the reads (each linked to its
+ * close), so a batch costs two io_uring_enter calls. Otherwise, or when the
+ * kernel refuses io_uring, each file is read with open/read/close.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CrossWindow
+{
+    namespace Proc
+    {
+
+        /**
+         * @brief One file to read, /proc/<pid>/<name>
+         */
+        struct ReadRequest
+        {
+            uint32_t pid = 0;
+            const char *name = nullptr;
+            std::string *out = nullptr; ///< Receives the contents
+            bool ok = false;            ///< Set when the file was read
+        };
+
+        class BatchReader
+        {
+        public:
+            BatchReader();
+            ~BatchReader();
+
+            BatchReader(const BatchReader &) = delete;
+            BatchReader &operator=(const BatchReader &) = delete;
+
+            /**
+             * @brief Read every requested file
+             */
+            void Read(ReadRequest *requests, size_t count);
+
+            void Read(std::vector<ReadRequest> &requests) { Read(requests.data(), requests.size()); }
+
+            /**
+             * @brief Whether batches currently go through io_uring
+             */
+            bool IsUsingIoUring() const;
+
+            /**
+             * @brief Use plain syscalls from now on
+             */
+            void DisableIoUring();
+
+            /**
+             * @brief Syscalls issued by Read so far
+             */
+            size_t GetSyscallCount() const { return m_syscalls; }
+
+            void ResetSyscallCount() { m_syscalls = 0; }
+
+        private:
+            void ReadPlain(ReadRequest &request);
+
+#ifdef CROSSWINDOW_HAVE_IO_URING
+            struct Ring;
+            bool ReadBatch(ReadRequest *requests, size_t count);
+            void CloseAll(const int *fds, size_t count); ///< After a failed submit; skips entries below 0
+
+            std::unique_ptr<Ring> m_ring;
+            std::vector<char> m_buffers;
+#endif
+            size_t m_syscalls = 0;
+        };
+
+    } // namespace Proc
+} // namespace CrossWindow
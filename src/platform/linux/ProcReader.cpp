@@ -0,0 +1,128 @@
+/**
+ * @file ProcReader.cpp
+ * @brief Small /proc readers used by the Linux backend
+ */
+
+#include "ProcReader.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace CrossWindow
+{
+    namespace Proc
+    {
+
+        bool ReadFile(uint32_t pid, const char *name, std::string &out, size_t *syscalls)
+        {
+            char path[64];
+            std::snprintf(path, sizeof(path), "/proc/%u/%s", pid, name);
+
+            size_t issued = 1;
+            int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                if (syscalls)
+                    *syscalls += issued;
+                return false;
+            }
+
+            // /proc files report a size of 0, so read until EOF
+            out.clear();
+            char buffer[4096];
+            for (;;)
+            {
+                ssize_t n = ::read(fd, buffer, sizeof(buffer));
+                ++issued;
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    break;
+                }
+                out.append(buffer, static_cast<size_t>(n));
+            }
+            ::close(fd);
+            if (syscalls)
+                *syscalls += issued + 1;
+            return true;
+        }
+
+        bool ReadLink(uint32_t pid, const char *name, std::string &out)
+        {
+            char path[64];
+            std::snprintf(path, sizeof(path), "/proc/%u/%s", pid, name);
+
+            char target[4096];
+            ssize_t n = ::readlink(path, target, sizeof(target));
+            if (n <= 0)
+            {
+                return false;
+            }
+            out.assign(target, static_cast<size_t>(n));
+            return true;
+        }
+
+        bool ParseStat(const std::string &text, StatFields &out)
+        {
+            size_t close = text.rfind(')');
+            if (close == std::string::npos)
+            {
+                return false;
+            }
+
+            // Field 3 (state) follows the command name; walk to fields 4, 14, 15 and 22
+            const char *p = text.c_str() + close + 1;
+            int field = 3;
+            while (*p)
+            {
+                while (*p == ' ')
+                {
+                    ++p;
+                }
+                if (!*p)
+                {
+                    break;
+                }
+
+                char *end = nullptr;
+                switch (field)
+                {
+                case 4:
+                    out.ppid = static_cast<uint32_t>(std::strtoul(p, &end, 10));
+                    break;
+                case 14:
+                    out.utimeTicks = std::strtoull(p, &end, 10);
+                    break;
+                case 15:
+                    out.stimeTicks = std::strtoull(p, &end, 10);
+                    break;
+                case 22:
+                    out.startTime = std::strtoull(p, &end, 10);
+                    return true;
+                default:
+                    break;
+                }
+
+                while (*p && *p != ' ')
+                {
+                    ++p;
+                }
+                ++field;
+            }
+            return false;
+        }
+
+        bool ReadStat(uint32_t pid, StatFields &out)
+        {
+            std::string text;
+            return ReadFile(pid, "stat", text) && ParseStat(text, out);
+        }
+
+    } // namespace Proc
+} // namespace CrossWindow
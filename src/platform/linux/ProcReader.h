@@ -0,0 +1,58 @@
+/**
+ * @file ProcReader.h
+ * @brief Small /proc readers used by the Linux backend
+ *
+ * Files are read with plain open/read/close into caller-provided buffers so
+ * that sampling many processes does not go through iostreams.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CrossWindow
+{
+    namespace Proc
+    {
+
+        /**
+         * @brief Read /proc/<pid>/<name> into out, replacing its contents
+         * @param syscalls Incremented by the number of syscalls issued, if given
+         * @return false if the file could not be opened (e.g. the process exited)
+         */
+        bool ReadFile(uint32_t pid, const char *name, std::string &out, size_t *syscalls = nullptr);
+
+        /**
+         * @brief Read the target of the symlink /proc/<pid>/<name>
+         * @return false if the link could not be read (exited or not permitted)
+         */
+        bool ReadLink(uint32_t pid, const char *name, std::string &out);
+
+        /**
+         * @brief Fields of /proc/<pid>/stat used by the backend
+         */
+        struct StatFields
+        {
+            uint32_t ppid = 0;
+            uint64_t utimeTicks = 0;
+            uint64_t stimeTicks = 0;
+            uint64_t startTime = 0; ///< Clock ticks after boot; tells reused PIDs apart
+        };
+
+        /**
+         * @brief Parse the contents of /proc/<pid>/stat
+         *
+         * The command name may contain spaces and parentheses, so fields are
+         * counted from the last ')'.
+         */
+        bool ParseStat(const std::string &text, StatFields &out);
+
+        /**
+         * @brief Read and parse /proc/<pid>/stat
+         */
+        bool ReadStat(uint32_t pid, StatFields &out);
+
+    } // namespace Proc
+} // namespace CrossWindow
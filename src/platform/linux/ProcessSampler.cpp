@@ -0,0 +1,148 @@
+/**
+ * @file ProcessSampler.cpp
+ * @brief CPU and memory sampling of window-owning processes
+ */
+
+#include "ProcessSampler.h"
+#include "ProcReader.h"
+#include <unistd.h>
+#include <cstdlib>
+#include <iterator>
+#include <unordered_set>
+
+namespace CrossWindow
+{
+
+    ProcessSampler::ProcessSampler()
+        : m_ticksPerSecond(sysconf(_SC_CLK_TCK)), m_pageSize(sysconf(_SC_PAGESIZE))
+    {
+    }
+
+    void ProcessSampler::SamplePass(const std::vector<uint32_t> &pids, Proc::BatchReader &reader)
+    {
+        std::unordered_set<uint32_t> seen;
+        std::vector<uint32_t> distinct;
+        seen.reserve(pids.size());
+        for (uint32_t pid : pids)
+        {
+            if (pid != 0 && seen.insert(pid).second)
+            {
+                distinct.push_back(pid);
+            }
+        }
+
+        std::vector<std::string> texts(distinct.size() * 2);
+        std::vector<Proc::ReadRequest> requests(distinct.size() * 2);
+        for (size_t i = 0; i < distinct.size(); ++i)
+        {
+            requests[2 * i] = {distinct[i], "stat", &texts[2 * i]};
+            requests[2 * i + 1] = {distinct[i], "statm", &texts[2 * i + 1]};
+        }
+        reader.Read(requests);
+
+        for (size_t i = 0; i < distinct.size(); ++i)
+        {
+            if (!requests[2 * i].ok || !requests[2 * i + 1].ok ||
+                !Record(distinct[i], texts[2 * i], texts[2 * i + 1]))
+            {
+                m_rings.erase(distinct[i]);
+            }
+        }
+
+        for (auto it = m_rings.begin(); it != m_rings.end();)
+        {
+            it = seen.count(it->first) ? std::next(it) : m_rings.erase(it);
+        }
+    }
+
+    bool ProcessSampler::Sample(uint32_t pid)
+    {
+        if (pid == 0 || !Proc::ReadFile(pid, "stat", m_stat) || !Proc::ReadFile(pid, "statm", m_statm) ||
+            !Record(pid, m_stat, m_statm))
+        {
+            m_rings.erase(pid);
+            return false;
+        }
+        return true;
+    }
+
+    bool ProcessSampler::Record(uint32_t pid, const std::string &statText, const std::string &statm)
+    {
+        Proc::StatFields stat;
+        if (!Proc::ParseStat(statText, stat))
+        {
+            return false;
+        }
+
+        // statm: size resident shared text lib data dt, in pages
+        const char *p = statm.c_str();
+        char *end = nullptr;
+        std::strtoull(p, &end, 10);
+        uint64_t residentPages = std::strtoull(end, nullptr, 10);
+
+        ResourceUsage usage;
+        usage.processId = pid;
+        usage.residentBytes = residentPages * static_cast<uint64_t>(m_pageSize);
+        uint64_t cpuTicks = stat.utimeTicks + stat.stimeTicks;
+        usage.cpuTimeMs = cpuTicks * 1000 / static_cast<uint64_t>(m_ticksPerSecond);
+        usage.sampledAt = std::chrono::steady_clock::now();
+
+        Ring &ring = m_rings[pid];
+        if (ring.count > 0 && ring.startTime != stat.startTime)
+        {
+            // PID reused by a new process; its history starts over
+            ring = Ring{};
+        }
+
+        if (ring.count > 0)
+        {
+            const ResourceUsage &previous = ring.samples[(ring.next + kHistory - 1) % kHistory];
+            double seconds = std::chrono::duration<double>(usage.sampledAt - previous.sampledAt).count();
+            if (seconds > 0.0 && cpuTicks >= ring.cpuTicks)
+            {
+                double cpuSeconds = static_cast<double>(cpuTicks - ring.cpuTicks) / m_ticksPerSecond;
+                usage.cpuPercent = cpuSeconds / seconds * 100.0;
+            }
+        }
+
+        ring.startTime = stat.startTime;
+        ring.cpuTicks = cpuTicks;
+        ring.samples[ring.next] = usage;
+        ring.next = (ring.next + 1) % kHistory;
+        if (ring.count < kHistory)
+        {
+            ++ring.count;
+        }
+        return true;
+    }
+
+    const ResourceUsage *ProcessSampler::Latest(uint32_t pid) const
+    {
+        auto it = m_rings.find(pid);
+        if (it == m_rings.end() || it->second.count == 0)
+        {
+            return nullptr;
+        }
+        const Ring &ring = it->second;
+        return &ring.samples[(ring.next + kHistory - 1) % kHistory];
+    }
+
+    std::vector<ResourceUsage> ProcessSampler::History(uint32_t pid) const
+    {
+        std::vector<ResourceUsage> history;
+        auto it = m_rings.find(pid);
+        if (it == m_rings.end())
+        {
+            return history;
+        }
+
+        const Ring &ring = it->second;
+        history.reserve(ring.count);
+        for (size_t i = 0; i < ring.count; ++i)
+        {
+            history.push_back(ring.samples[(ring.next + kHistory - ring.count + i) % kHistory]);
+        }
+        return history;
+    }
+
+} // namespace CrossWindow
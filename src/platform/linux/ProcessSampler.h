@@ -0,0 +1,77 @@
+/**
+ * @file ProcessSampler.h
+ * @brief CPU and memory sampling of window-owning processes
+ *
+ * Each process keeps a short ring of recent samples. CPU% is the CPU time
+ * consumed between the two most recent samples divided by the wall time
+ * between them.
+ */
+
+#pragma once
+
+#include "CrossWindow.h"
+#include "ProcBatchReader.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CrossWindow
+{
+
+    class ProcessSampler
+    {
+    public:
+        static constexpr size_t kHistory = 16; ///< Samples kept per process
+
+        ProcessSampler();
+
+        /**
+         * @brief Sample every distinct PID once
+         *
+         * All stat and statm files of the pass go through one batched read.
+         * Rings of processes not in the list are dropped, so a full pass also
+         * forgets processes that went away.
+         */
+        void SamplePass(const std::vector<uint32_t> &pids, Proc::BatchReader &reader);
+
+        /**
+         * @brief Sample a single process, keeping the other rings
+         * @return false if the process does not exist
+         */
+        bool Sample(uint32_t pid);
+
+        /**
+         * @brief Most recent sample of a process
+         * @return nullptr if the process has not been sampled
+         */
+        const ResourceUsage *Latest(uint32_t pid) const;
+
+        /**
+         * @brief Recent samples of a process, oldest first
+         */
+        std::vector<ResourceUsage> History(uint32_t pid) const;
+
+        void Clear() { m_rings.clear(); }
+
+    private:
+        bool Record(uint32_t pid, const std::string &stat, const std::string &statm);
+
+        struct Ring
+        {
+            uint64_t startTime = 0;
+            uint64_t cpuTicks = 0; ///< utime + stime of the newest sample
+            std::array<ResourceUsage, kHistory> samples;
+            size_t next = 0;
+            size_t count = 0;
+        };
+
+        long m_ticksPerSecond;
+        long m_pageSize;
+        std::string m_stat;
+        std::string m_statm;
+        std::unordered_map<uint32_t, Ring> m_rings;
+    };
+
+} // namespace CrossWindow
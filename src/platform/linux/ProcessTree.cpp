@@ -0,0 +1,137 @@
+/**
+ * @file ProcessTree.cpp
+ * @brief Parent links between window-owning processes
+ */
+
+#include "ProcessTree.h"
+#include "ProcReader.h"
+#include <unordered_set>
+
+namespace CrossWindow
+{
+
+    namespace
+    {
+        // Parent chains are short in practice; the cap only guards against a
+        // chain changing underneath us while it is read
+        constexpr int kMaxDepth = 64;
+    } // namespace
+
+    void ProcessTree::Build(const std::vector<uint32_t> &pids, Proc::BatchReader &reader)
+    {
+        m_nodes.clear();
+
+        std::vector<uint32_t> level;
+        std::unordered_set<uint32_t> queued;
+        for (uint32_t pid : pids)
+        {
+            if (pid > 1 && queued.insert(pid).second)
+            {
+                level.push_back(pid);
+            }
+        }
+
+        std::vector<std::string> texts;
+        std::vector<Proc::ReadRequest> requests;
+        for (int depth = 0; !level.empty() && depth < kMaxDepth; ++depth)
+        {
+            texts.assign(level.size(), std::string());
+            requests.assign(level.size(), Proc::ReadRequest{});
+            for (size_t i = 0; i < level.size(); ++i)
+            {
+                requests[i] = {level[i], "stat", &texts[i]};
+            }
+            reader.Read(requests);
+
+            std::vector<uint32_t> parents;
+            for (size_t i = 0; i < level.size(); ++i)
+            {
+                Proc::StatFields stat;
+                if (!requests[i].ok || !Proc::ParseStat(texts[i], stat))
+                {
+                    continue;
+                }
+
+                const std::string &text = texts[i];
+                Node node;
+                node.ppid = stat.ppid;
+                size_t open = text.find('(');
+                size_t close = text.rfind(')');
+                if (open != std::string::npos && close > open)
+                {
+                    node.name = text.substr(open + 1, close - open - 1);
+                }
+
+                if (Proc::ReadLink(level[i], "exe", node.identity))
+                {
+                    // An upgraded binary keeps running under its old, deleted path
+                    const std::string deleted = " (deleted)";
+                    if (node.identity.size() > deleted.size() &&
+                        node.identity.compare(node.identity.size() - deleted.size(), deleted.size(), deleted) == 0)
+                    {
+                        node.identity.resize(node.identity.size() - deleted.size());
+                    }
+                }
+                else
+                {
+                    node.identity = "comm:" + node.name;
+                }
+
+                m_nodes.emplace(level[i], std::move(node));
+                if (stat.ppid > 1 && queued.insert(stat.ppid).second)
+                {
+                    parents.push_back(stat.ppid);
+                }
+            }
+            level.swap(parents);
+        }
+    }
+
+    uint32_t ProcessTree::ApplicationRoot(uint32_t pid) const
+    {
+        uint32_t root = pid;
+        const Node *node = Find(pid);
+        for (int depth = 0; node && depth < kMaxDepth; ++depth)
+        {
+            const Node *parent = Find(node->ppid);
+            if (!parent || parent->identity != node->identity)
+            {
+                break;
+            }
+            root = node->ppid;
+            node = parent;
+        }
+        return root;
+    }
+
+    bool ProcessTree::IsInTree(uint32_t pid, uint32_t ancestor) const
+    {
+        for (int depth = 0; pid > 1 && depth < kMaxDepth; ++depth)
+        {
+            if (pid == ancestor)
+            {
+                return true;
+            }
+            const Node *node = Find(pid);
+            if (!node)
+            {
+                return false;
+            }
+            pid = node->ppid;
+        }
+        return pid == ancestor && ancestor != 0;
+    }
+
+    std::string ProcessTree::Name(uint32_t pid) const
+    {
+        const Node *node = Find(pid);
+        return node ? node->name : std::string();
+    }
+
+    const ProcessTree::Node *ProcessTree::Find(uint32_t pid) const
+    {
+        auto it = m_nodes.find(pid);
+        return it != m_nodes.end() ? &it->second : nullptr;
+    }
+
+} // namespace CrossWindow
@@ -0,0 +1,65 @@
+/**
+ * @file ProcessTree.h
+ * @brief Parent links between window-owning processes
+ *
+ * Multi-process applications (browsers, Electron) own windows from helper
+ * processes. The tree is built once per pass from the ppid field of
+ * /proc/<pid>/stat, covering the window owners and their ancestors only.
+ */
+
+#pragma once
+
+#include "ProcBatchReader.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CrossWindow
+{
+
+    class ProcessTree
+    {
+    public:
+        /**
+         * @brief Rebuild the tree for the given processes and their ancestors
+         *
+         * Every process is read at most once, however many of the inputs share it
+         * as an ancestor. Each generation of parents is one batched read.
+         */
+        void Build(const std::vector<uint32_t> &pids, Proc::BatchReader &reader);
+
+        /**
+         * @brief Topmost ancestor running the same executable as pid
+         *
+         * Helper processes of an application share its executable, whereas the
+         * launcher above it (shell, session manager, init) does not.
+         *
+         * @return The application root, or pid itself if it is not in the tree
+         */
+        uint32_t ApplicationRoot(uint32_t pid) const;
+
+        /**
+         * @brief Check whether pid is ancestor itself or one of its descendants
+         */
+        bool IsInTree(uint32_t pid, uint32_t ancestor) const;
+
+        /**
+         * @brief Command name of a process in the tree
+         */
+        std::string Name(uint32_t pid) const;
+
+    private:
+        struct Node
+        {
+            uint32_t ppid = 0;
+            std::string name;     ///< Command name from stat
+            std::string identity; ///< Executable path, or the command name when unreadable
+        };
+
+        const Node *Find(uint32_t pid) const;
+
+        std::unordered_map<uint32_t, Node> m_nodes;
+    };
+
+} // namespace CrossWindow
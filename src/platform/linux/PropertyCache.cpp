@@ -0,0 +1,142 @@
+/**
+ * @file PropertyCache.cpp
+ * @brief Window properties kept until PropertyNotify says they changed
+ */
+
+#include "PropertyCache.h"
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        PropertyValue PropertyValue::FromReply(const xcb_get_property_reply_t *reply)
+        {
+            PropertyValue value;
+            if (!reply)
+            {
+                return value;
+            }
+
+            value.type = reply->type;
+            value.format = reply->format;
+            value.bytesAfter = reply->bytes_after;
+            const uint8_t *data = static_cast<const uint8_t *>(xcb_get_property_value(reply));
+            value.data.assign(data, data + xcb_get_property_value_length(reply));
+            return value;
+        }
+
+        bool PropertyCache::Lookup(xcb_window_t window, xcb_atom_t atom, xcb_atom_t type, uint32_t length,
+                                   PropertyValue &out)
+        {
+            auto it = m_index.find(Key(window, atom, type));
+            if (it != m_index.end() && Serve(it, length, out))
+            {
+                return true;
+            }
+            if (type != XCB_GET_PROPERTY_TYPE_ANY)
+            {
+                return false;
+            }
+
+            // A typed read whose type matched got the same bytes an ANY read would
+            for (it = m_index.lower_bound(Key(window, atom, 0));
+                 it != m_index.end() && std::get<0>(it->first) == window && std::get<1>(it->first) == atom; ++it)
+            {
+                if (it->second->value.type == std::get<2>(it->first) && Serve(it, length, out))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool PropertyCache::Serve(Index::iterator it, uint32_t length, PropertyValue &out)
+        {
+            const Entry &entry = *it->second;
+            if (entry.value.bytesAfter > 0 && entry.length < length)
+            {
+                return false;
+            }
+
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+            // Serve exactly what the server would have returned for the shorter request
+            out = entry.value;
+            size_t maxBytes = static_cast<size_t>(length) * 4;
+            if (out.data.size() > maxBytes)
+            {
+                out.bytesAfter += static_cast<uint32_t>(out.data.size() - maxBytes);
+                out.data.resize(maxBytes);
+            }
+            return true;
+        }
+
+        void PropertyCache::Store(xcb_window_t window, xcb_atom_t atom, xcb_atom_t type, uint32_t length,
+                                  const xcb_get_property_reply_t *reply)
+        {
+            if (!reply || m_maxEntries == 0)
+            {
+                return;
+            }
+
+            Key key(window, atom, type);
+            auto it = m_index.find(key);
+            if (it != m_index.end())
+            {
+                Erase(it);
+            }
+
+            Entry entry;
+            entry.key = key;
+            entry.length = length;
+            entry.value = PropertyValue::FromReply(reply);
+            if (entry.value.data.size() > m_maxBytes)
+            {
+                return;
+            }
+
+            m_bytes += entry.value.data.size();
+            m_entries.push_front(std::move(entry));
+            m_index.emplace(key, m_entries.begin());
+
+            while (m_index.size() > m_maxEntries || m_bytes > m_maxBytes)
+            {
+                Erase(m_index.find(m_entries.back().key));
+            }
+        }
+
+        void PropertyCache::Invalidate(xcb_window_t window, xcb_atom_t atom)
+        {
+            auto it = m_index.lower_bound(Key(window, atom, 0));
+            while (it != m_index.end() && std::get<0>(it->first) == window && std::get<1>(it->first) == atom)
+            {
+                Erase(it++);
+            }
+        }
+
+        void PropertyCache::InvalidateWindow(xcb_window_t window)
+        {
+            auto it = m_index.lower_bound(Key(window, 0, 0));
+            while (it != m_index.end() && std::get<0>(it->first) == window)
+            {
+                Erase(it++);
+            }
+        }
+
+        void PropertyCache::Clear()
+        {
+            m_entries.clear();
+            m_index.clear();
+            m_bytes = 0;
+        }
+
+        void PropertyCache::Erase(Index::iterator it)
+        {
+            m_bytes -= it->second->value.data.size();
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+
+    } // namespace Xcb
+} // namespace CrossWindow
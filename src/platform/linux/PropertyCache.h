@@ -0,0 +1,126 @@
+/**
+ * @file PropertyCache.h
+ * @brief Window properties kept until PropertyNotify says they changed
+ *
+ * Windows handed out by the backend have PropertyChange selected, so the
+ * server reports every change to any of their properties. A property read
+ * from such a window can therefore be kept and served again without a
+ * round trip until the notification for that window and atom arrives.
+ * Entries are evicted least recently used first once the entry or byte
+ * budget is exceeded.
+ */
+
+#pragma once
+
+#include <xcb/xcb.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        /**
+         * @brief The parts of a GetProperty reply needed to decode it again
+         */
+        struct PropertyValue
+        {
+            xcb_atom_t type = XCB_NONE; ///< Actual type; XCB_NONE if the property does not exist
+            uint8_t format = 0;
+            uint32_t bytesAfter = 0;    ///< Bytes not returned, past the requested length
+            std::vector<uint8_t> data;
+
+            size_t Count() const { return format ? data.size() / (format / 8) : 0; }
+
+            template <typename T>
+            const T *As() const { return reinterpret_cast<const T *>(data.data()); }
+
+            /**
+             * @brief Copy a reply; a missing reply gives an empty value
+             */
+            static PropertyValue FromReply(const xcb_get_property_reply_t *reply);
+        };
+
+        /**
+         * @brief LRU cache of property values keyed by (window, atom, requested type)
+         *
+         * Reads of the same property with different requested types are kept
+         * side by side. A value is served for the same requested type, or for
+         * AnyPropertyType from an entry whose actual type matched its request,
+         * and only if it was read in full or with at least the length asked for
+         * now. Not thread-safe; the backend uses it from the thread that owns
+         * the connection.
+         */
+        class PropertyCache
+        {
+        public:
+            static constexpr size_t kDefaultMaxEntries = 4096;
+            static constexpr size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+            explicit PropertyCache(size_t maxEntries = kDefaultMaxEntries, size_t maxBytes = kDefaultMaxBytes)
+                : m_maxEntries(maxEntries), m_maxBytes(maxBytes)
+            {
+            }
+
+            /**
+             * @brief Find a cached value
+             * @param length Requested length in 32-bit units; a longer cached value is cut to it
+             * @return false on a miss
+             */
+            bool Lookup(xcb_window_t window, xcb_atom_t atom, xcb_atom_t type, uint32_t length,
+                        PropertyValue &out);
+
+            /**
+             * @brief Remember a reply read with the given request parameters
+             *
+             * Only call for windows whose PropertyChange selection was sent
+             * before the request, or a change in between would go unnoticed.
+             */
+            void Store(xcb_window_t window, xcb_atom_t atom, xcb_atom_t type, uint32_t length,
+                       const xcb_get_property_reply_t *reply);
+
+            /**
+             * @brief Drop one property, as read with any type, after PropertyNotify
+             */
+            void Invalidate(xcb_window_t window, xcb_atom_t atom);
+
+            /**
+             * @brief Drop every property of a window after DestroyNotify
+             */
+            void InvalidateWindow(xcb_window_t window);
+
+            void Clear();
+
+            size_t Size() const { return m_index.size(); }
+
+        private:
+            using Key = std::tuple<xcb_window_t, xcb_atom_t, xcb_atom_t>; ///< Window, atom, requested type
+
+            struct Entry
+            {
+                Key key;
+                uint32_t length = 0;
+                PropertyValue value;
+            };
+
+            using EntryList = std::list<Entry>;
+
+            using Index = std::map<Key, EntryList::iterator>;
+
+            void Erase(Index::iterator it);
+            bool Serve(Index::iterator it, uint32_t length, PropertyValue &out);
+
+            size_t m_maxEntries;
+            size_t m_maxBytes;
+            size_t m_bytes = 0;
+            EntryList m_entries;                           ///< Most recently used first
+            Index m_index;                                 ///< Ordered so a window's entries are adjacent
+        };
+
+    } // namespace Xcb
+} // namespace CrossWindow
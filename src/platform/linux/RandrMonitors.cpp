@@ -0,0 +1,343 @@
+/**
+ * @file RandrMonitors.cpp
+ * @brief Monitor layout through the RandR extension
+ */
+
+#include "RandrMonitors.h"
+#include <xcb/xcbext.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        namespace
+        {
+            // libxcb-randr is not always installed, so the three requests used here
+            // are encoded by hand (see randrproto.h)
+            xcb_extension_t g_randrExtension = {"RANDR", 0};
+
+            constexpr uint8_t kRRQueryVersion = 0;
+            constexpr uint8_t kRRSelectInput = 4;
+            constexpr uint8_t kRRGetMonitors = 42;
+
+            // ScreenChangeNotify covers resolution changes; CRTC and output changes
+            // are also needed to see a monitor move or turn off without the screen
+            // size changing
+            constexpr uint16_t kRRScreenChangeNotifyMask = 1u << 0;
+            constexpr uint16_t kRRCrtcChangeNotifyMask = 1u << 1;
+            constexpr uint16_t kRROutputChangeNotifyMask = 1u << 2;
+
+            constexpr uint8_t kRRScreenChangeNotify = 0;
+            constexpr uint8_t kRRNotify = 1;
+
+            struct QueryVersionRequest
+            {
+                uint8_t majorOpcode;
+                uint8_t minorOpcode;
+                uint16_t length;
+                uint32_t clientMajor;
+                uint32_t clientMinor;
+            };
+
+            struct QueryVersionReply
+            {
+                uint8_t responseType;
+                uint8_t pad0;
+                uint16_t sequence;
+                uint32_t length;
+                uint32_t serverMajor;
+                uint32_t serverMinor;
+                uint8_t pad1[16];
+            };
+
+            struct SelectInputRequest
+            {
+                uint8_t majorOpcode;
+                uint8_t minorOpcode;
+                uint16_t length;
+                uint32_t window;
+                uint16_t enable;
+                uint16_t pad;
+            };
+
+            struct GetMonitorsRequest
+            {
+                uint8_t majorOpcode;
+                uint8_t minorOpcode;
+                uint16_t length;
+                uint32_t window;
+                uint8_t getActive;
+                uint8_t pad[3];
+            };
+
+            struct GetMonitorsReply
+            {
+                uint8_t responseType;
+                uint8_t pad0;
+                uint16_t sequence;
+                uint32_t length;
+                uint32_t timestamp;
+                uint32_t numMonitors;
+                uint32_t numOutputs;
+                uint8_t pad1[12];
+            };
+
+            struct MonitorRecord
+            {
+                uint32_t name; // Atom
+                uint8_t primary;
+                uint8_t automatic;
+                uint16_t numOutputs; // CARD32 output ids follow the record
+                int16_t x;
+                int16_t y;
+                uint16_t width;
+                uint16_t height;
+                uint32_t widthMm;
+                uint32_t heightMm;
+            };
+
+            void SetPhysicalSize(MonitorInfo &monitor, uint32_t widthMm, uint32_t heightMm)
+            {
+                monitor.widthMm = widthMm;
+                monitor.heightMm = heightMm;
+                if (widthMm == 0 || monitor.rect.width <= 0)
+                {
+                    return;
+                }
+
+                monitor.dpi = monitor.rect.width * 25.4 / widthMm;
+                monitor.scaleHint = std::max(1.0, std::round(monitor.dpi / 96.0 * 4.0) / 4.0);
+            }
+        } // namespace
+
+        int LargestOverlap(const Rect &rect, const std::vector<MonitorInfo> &monitors)
+        {
+            int best = -1;
+            int64_t bestArea = 0;
+            for (size_t i = 0; i < monitors.size(); ++i)
+            {
+                const Rect &m = monitors[i].rect;
+                int64_t w = std::min<int64_t>(int64_t(rect.x) + rect.width, int64_t(m.x) + m.width) -
+                            std::max(rect.x, m.x);
+                int64_t h = std::min<int64_t>(int64_t(rect.y) + rect.height, int64_t(m.y) + m.height) -
+                            std::max(rect.y, m.y);
+                if (w > 0 && h > 0 && w * h > bestArea)
+                {
+                    bestArea = w * h;
+                    best = static_cast<int>(i);
+                }
+            }
+            return best;
+        }
+
+        bool RandrMonitors::Initialize(xcb_connection_t *conn, xcb_window_t root, bool selectInput)
+        {
+            ReplyWait wait;
+            return CompleteInitialize(conn, RequestVersion(conn, root), selectInput, wait);
+        }
+
+        void RandrMonitors::Prefetch(xcb_connection_t *conn)
+        {
+            xcb_prefetch_extension_data(conn, &g_randrExtension);
+        }
+
+        unsigned int RandrMonitors::RequestVersion(xcb_connection_t *conn, xcb_window_t root)
+        {
+            Reset();
+            m_root = root;
+
+            const xcb_query_extension_reply_t *ext = xcb_get_extension_data(conn, &g_randrExtension);
+            if (!ext || !ext->present)
+            {
+                return 0;
+            }
+            m_eventBase = ext->first_event;
+
+            // GetMonitors needs protocol 1.5
+            QueryVersionRequest request{};
+            request.clientMajor = 1;
+            request.clientMinor = 5;
+
+            static const xcb_protocol_request_t protocol = {1, &g_randrExtension, kRRQueryVersion, 0};
+            struct iovec parts[3];
+            parts[2].iov_base = &request;
+            parts[2].iov_len = sizeof(request);
+            return xcb_send_request(conn, XCB_REQUEST_CHECKED, parts + 2, &protocol);
+        }
+
+        bool RandrMonitors::CompleteInitialize(xcb_connection_t *conn, unsigned int sequence, bool selectInput,
+                                               ReplyWait &wait)
+        {
+            if (sequence == 0)
+            {
+                return false;
+            }
+
+            Reply<QueryVersionReply> reply(static_cast<QueryVersionReply *>(WaitForReply(conn, sequence, wait)));
+            if (!reply || reply->serverMajor < 1 || (reply->serverMajor == 1 && reply->serverMinor < 5))
+            {
+                return false;
+            }
+
+            if (selectInput)
+            {
+                SelectInputRequest select{};
+                select.window = m_root;
+                select.enable = kRRScreenChangeNotifyMask | kRRCrtcChangeNotifyMask | kRROutputChangeNotifyMask;
+
+                static const xcb_protocol_request_t protocol = {1, &g_randrExtension, kRRSelectInput, 1};
+                struct iovec parts[3];
+                parts[2].iov_base = &select;
+                parts[2].iov_len = sizeof(select);
+                xcb_send_request(conn, 0, parts + 2, &protocol);
+            }
+
+            m_available = true;
+            return true;
+        }
+
+        void RandrMonitors::Reset()
+        {
+            m_available = false;
+            m_valid = false;
+            m_eventBase = 0;
+            m_root = XCB_NONE;
+            m_monitors.clear();
+            m_names.clear();
+        }
+
+        bool RandrMonitors::HandleEvent(uint8_t responseType)
+        {
+            if (!m_available)
+            {
+                return false;
+            }
+
+            if (responseType == m_eventBase + kRRScreenChangeNotify || responseType == m_eventBase + kRRNotify)
+            {
+                m_valid = false;
+                return true;
+            }
+            return false;
+        }
+
+        const std::vector<MonitorInfo> &RandrMonitors::Get(xcb_connection_t *conn, ReplyWait &wait)
+        {
+            if (!m_valid)
+            {
+                if (m_available)
+                {
+                    Query(conn, wait);
+                }
+                else
+                {
+                    QueryScreen(conn);
+                }
+            }
+            return m_monitors;
+        }
+
+        void RandrMonitors::Query(xcb_connection_t *conn, ReplyWait &wait)
+        {
+            GetMonitorsRequest request{};
+            request.window = m_root;
+            request.getActive = 1;
+
+            static const xcb_protocol_request_t protocol = {1, &g_randrExtension, kRRGetMonitors, 0};
+            struct iovec parts[3];
+            parts[2].iov_base = &request;
+            parts[2].iov_len = sizeof(request);
+            unsigned int sequence = xcb_send_request(conn, XCB_REQUEST_CHECKED, parts + 2, &protocol);
+
+            Reply<GetMonitorsReply> reply(static_cast<GetMonitorsReply *>(WaitForReply(conn, sequence, wait)));
+            if (!reply)
+            {
+                return;
+            }
+
+            std::vector<MonitorInfo> monitors;
+            std::vector<xcb_atom_t> nameAtoms;
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(reply.get()) + sizeof(GetMonitorsReply);
+            const uint8_t *end = data + static_cast<size_t>(reply->length) * 4;
+            for (uint32_t i = 0; i < reply->numMonitors && data + sizeof(MonitorRecord) <= end; ++i)
+            {
+                MonitorRecord record;
+                std::memcpy(&record, data, sizeof(record));
+                data += sizeof(record) + static_cast<size_t>(record.numOutputs) * 4;
+
+                MonitorInfo monitor;
+                monitor.rect = {record.x, record.y, record.width, record.height};
+                monitor.primary = record.primary != 0;
+                SetPhysicalSize(monitor, record.widthMm, record.heightMm);
+                monitors.push_back(std::move(monitor));
+                nameAtoms.push_back(record.name);
+            }
+
+            // Names only need resolving the first time an atom is seen; the rest
+            // share one round trip
+            std::vector<std::pair<xcb_atom_t, xcb_get_atom_name_cookie_t>> lookups;
+            for (xcb_atom_t atom : nameAtoms)
+            {
+                if (atom != XCB_NONE && !m_names.count(atom) &&
+                    std::none_of(lookups.begin(), lookups.end(), [&](const auto &l)
+                                 { return l.first == atom; }))
+                {
+                    lookups.emplace_back(atom, xcb_get_atom_name(conn, atom));
+                }
+            }
+            for (auto &lookup : lookups)
+            {
+                Reply<xcb_get_atom_name_reply_t> name(
+                    static_cast<xcb_get_atom_name_reply_t *>(WaitForReply(conn, lookup.second.sequence, wait)));
+                if (name)
+                {
+                    m_names[lookup.first].assign(xcb_get_atom_name_name(name.get()),
+                                                 xcb_get_atom_name_name_length(name.get()));
+                }
+            }
+            if (wait.timedOut)
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < monitors.size(); ++i)
+            {
+                auto it = m_names.find(nameAtoms[i]);
+                if (it != m_names.end())
+                {
+                    monitors[i].name = it->second;
+                }
+            }
+
+            m_monitors = std::move(monitors);
+            m_valid = true;
+        }
+
+        void RandrMonitors::QueryScreen(xcb_connection_t *conn)
+        {
+            m_monitors.clear();
+            for (auto it = xcb_setup_roots_iterator(xcb_get_setup(conn)); it.rem; xcb_screen_next(&it))
+            {
+                if (it.data->root == m_root)
+                {
+                    MonitorInfo monitor;
+                    monitor.name = "default";
+                    monitor.rect = {0, 0, it.data->width_in_pixels, it.data->height_in_pixels};
+                    monitor.primary = true;
+                    SetPhysicalSize(monitor, it.data->width_in_millimeters, it.data->height_in_millimeters);
+                    m_monitors.push_back(std::move(monitor));
+                    break;
+                }
+            }
+
+            // The screen size is fixed for the life of the connection without RandR
+            m_valid = true;
+        }
+
+    } // namespace Xcb
+} // namespace CrossWindow
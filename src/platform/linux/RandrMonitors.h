@@ -0,0 +1,91 @@
+/**
+ * @file RandrMonitors.h
+ * @brief Monitor layout through the RandR extension
+ *
+ * RandR 1.5 describes the desktop as a list of monitors, each with its
+ * geometry, physical size and primary flag, in a single GetMonitors request.
+ * The list is kept until the server reports a screen, CRTC or output change,
+ * so asking for it again costs nothing while the layout is stable.
+ */
+
+#pragma once
+
+#include "XcbPipeline.h"
+#include <unordered_map>
+#include <vector>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        /**
+         * @brief Index of the monitor sharing the largest area with a rectangle
+         * @return -1 if the rectangle overlaps none of them
+         */
+        int LargestOverlap(const Rect &rect, const std::vector<MonitorInfo> &monitors);
+
+        /**
+         * @brief Caches the monitor list of one screen
+         */
+        class RandrMonitors
+        {
+        public:
+            /**
+             * @brief Check for RandR 1.5 and subscribe to layout changes on the root
+             * @param selectInput false when the owner of the connection selects
+             *        RandR events itself; the cache then relies on it forwarding them
+             * @return true if GetMonitors can be used
+             */
+            bool Initialize(xcb_connection_t *conn, xcb_window_t root, bool selectInput = true);
+
+            /**
+             * @brief Ask for the extension data without waiting for it
+             */
+            static void Prefetch(xcb_connection_t *conn);
+
+            /**
+             * @brief First half of Initialize: send QueryVersion without waiting
+             * @return Sequence of the request, or 0 if RandR is absent
+             */
+            unsigned int RequestVersion(xcb_connection_t *conn, xcb_window_t root);
+
+            /**
+             * @brief Second half of Initialize: check the version and select input
+             */
+            bool CompleteInitialize(xcb_connection_t *conn, unsigned int sequence, bool selectInput,
+                                    ReplyWait &wait);
+
+            void Reset();
+
+            bool IsAvailable() const { return m_available; }
+
+            /**
+             * @brief Drop the cached list if an event announces a layout change
+             * @param responseType Event code without the synthetic bit
+             * @return true if the event was a RandR notification
+             */
+            bool HandleEvent(uint8_t responseType);
+
+            /**
+             * @brief Monitors of the screen, queried only when the cache is stale
+             *
+             * Without RandR 1.5 the root window is reported as one monitor. On
+             * timeout the previous list is kept and stays marked as stale.
+             */
+            const std::vector<MonitorInfo> &Get(xcb_connection_t *conn, ReplyWait &wait);
+
+        private:
+            void Query(xcb_connection_t *conn, ReplyWait &wait);
+            void QueryScreen(xcb_connection_t *conn);
+
+            bool m_available = false;
+            bool m_valid = false;
+            uint8_t m_eventBase = 0;
+            xcb_window_t m_root = XCB_NONE;
+            std::vector<MonitorInfo> m_monitors;
+            std::unordered_map<xcb_atom_t, std::string> m_names; ///< Monitor name atoms seen so far
+        };
+
+    } // namespace Xcb
+} // namespace CrossWindow
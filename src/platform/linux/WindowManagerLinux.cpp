@@ -4,21 +4,23 @@
  */
 
 #include "WindowManagerLinux.h"
+#include "ProcReader.h"
 #include <algorithm>
+#include <chrono>
 #include <cctype>
 #include <cstring>
-#include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <X11/Xutil.h>
 
+#ifdef CROSSWINDOW_HAVE_X11_XCB
+#include <X11/Xlib-xcb.h>
+#endif
+
 // X11 headers define Success as a macro (value 0), which conflicts with our ErrorCode::Success
-// Save the value and undefine the macro
-#ifdef Success
-static constexpr int X11Success = Success;
 #undef Success
-#else
-static constexpr int X11Success = 0;
-#endif
 
 namespace CrossWindow
 {
@@ -30,24 +32,219 @@ namespace CrossWindow
         Shutdown();
     }
 
+    namespace
+    {
+        // Reconnect attempts start right after a loss and back off exponentially
+        constexpr std::chrono::milliseconds kReconnectInitialDelay{250};
+        constexpr std::chrono::milliseconds kReconnectMaxDelay{30000};
+
+        // Selected on every window handed out: destruction retires its WindowId
+        // generation, property changes invalidate its cached properties
+        constexpr uint32_t kFollowedWindowEvents = XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_PROPERTY_CHANGE;
+
+        // GetProperty lengths are in 32-bit units; round byte caps up to whole units
+        uint32_t LengthFor(uint32_t bytes)
+        {
+            return bytes / 4 + (bytes % 4 != 0);
+        }
+
+        // Outcome of a deadline-bounded read from the state its replies left behind
+        template <typename T>
+        void SetDeadlineError(Result<T> &result, const Xcb::ReplyWait &wait)
+        {
+            if (wait.timedOut)
+            {
+                result.value = T();
+                result.error = ErrorCode::Timeout;
+                result.errorMessage = "Timed out waiting for the X server"_msg;
+            }
+            else if (wait.failed)
+            {
+                result.value = T();
+                result.error = ErrorCode::InvalidHandle;
+                result.errorMessage = "Invalid window handle"_msg;
+            }
+            else
+            {
+                result.error = ErrorCode::Success;
+            }
+        }
+    } // namespace
+
     bool WindowManagerLinux::Initialize()
+    {
+        return Initialize(std::string());
+    }
+
+    bool WindowManagerLinux::Initialize(const std::string &displayName)
     {
         if (m_initialized)
         {
-            return true;
+            if (m_connected)
+            {
+                return true;
+            }
+            Shutdown();
+        }
+
+        if (!OpenConnection(displayName))
+        {
+            return false;
+        }
+        m_requestedDisplay = displayName;
+        return true;
+    }
+
+    bool WindowManagerLinux::Initialize(const ExternalConnection &connection)
+    {
+        if (m_initialized)
+        {
+            if (m_connected)
+            {
+                return true;
+            }
+            Shutdown();
+        }
+
+        // Window control still goes through Xlib, so a Display is required
+        if (!connection.display)
+        {
+            SetLastError("An Xlib Display is required to adopt a connection"_msg);
+            return false;
+        }
+
+        m_display = static_cast<Display *>(connection.display);
+        m_ownsDisplay = connection.takeOwnership;
+        m_adopted = true;
+        m_xcb = static_cast<xcb_connection_t *>(connection.xcbConnection);
+        m_ownsXcb = m_xcb && connection.takeOwnership;
+#ifdef CROSSWINDOW_HAVE_X11_XCB
+        // The Display's own XCB connection is closed by XCloseDisplay; disconnecting
+        // it as well would close it twice
+        if (!m_xcb || m_xcb == XGetXCBConnection(m_display))
+        {
+            m_xcb = XGetXCBConnection(m_display);
+            m_ownsXcb = false;
+        }
+#endif
+        if (!m_xcb || xcb_connection_has_error(m_xcb))
+        {
+            SetLastError("The adopted connection has no usable XCB connection"_msg);
+            m_xcb = nullptr;
+            m_display = nullptr;
+            return false;
         }
 
-        m_display = XOpenDisplay(nullptr);
+        // The host keeps reading its own event queue and forwards what it reads
+        // through ProcessEvent, so nothing here may take events off the connection.
+        // Its IO error handling is left alone as well.
+        InitializeConnection(connection.selectEvents);
+        return true;
+    }
+
+    bool WindowManagerLinux::OpenConnection(const std::string &displayName)
+    {
+        // Managers may run on different threads (MultiDisplayManager does), and
+        // Xlib must know before its first call opens a Display (libX11 1.8+
+        // does this on its own)
+        static std::once_flag threadsInitialized;
+        std::call_once(threadsInitialized, []()
+                       { XInitThreads(); });
+
+        m_display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
         if (!m_display)
         {
-            SetLastError("Failed to open X11 display");
+            SetLastError(displayName.empty() ? "Failed to open X11 display"
+                                             : "Failed to open X11 display " + displayName);
+            return false;
+        }
+        m_ownsDisplay = true;
+        m_adopted = false;
+
+#ifdef CROSSWINDOW_HAVE_X11_XCB
+        m_xcb = XGetXCBConnection(m_display);
+        m_ownsXcb = false;
+#else
+        m_xcb = xcb_connect(DisplayString(m_display), nullptr);
+        m_ownsXcb = true;
+        if (xcb_connection_has_error(m_xcb))
+        {
+            xcb_disconnect(m_xcb);
+            m_xcb = nullptr;
+            XCloseDisplay(m_display);
+            m_display = nullptr;
+            SetLastError("Failed to open XCB connection"_msg);
             return false;
         }
+#endif
+
+#ifdef CROSSWINDOW_HAVE_XIO_EXIT_HANDLER
+        // Xlib exits the process after an IO error unless the exit handler
+        // returns; the loss is picked up by the next CheckConnection instead
+        XSetIOErrorExitHandler(m_display, &WindowManagerLinux::OnIOErrorExit, this);
+#endif
+
+        // Root property changes (desktop switches) and RandR layout changes arrive
+        // as events on the XCB connection; they are drained before cached root
+        // state is used. Xlib then sends its requests unchecked, so errors of the
+        // remaining Xlib calls (all without replies) arrive as events too and never
+        // reach Xlib's error handler; everything that waits for a reply goes through XCB
+#ifdef CROSSWINDOW_HAVE_X11_XCB
+        XSetEventQueueOwner(m_display, XCBOwnsEventQueue);
+#endif
+        InitializeConnection(true);
+        return true;
+    }
 
+    void WindowManagerLinux::InitializeConnection(bool selectEvents)
+    {
+        m_displayName = DisplayString(m_display);
         m_rootWindow = DefaultRootWindow(m_display);
-        InitializeAtoms();
+        m_fetch.root = static_cast<xcb_window_t>(m_rootWindow);
+        m_fetch.limits = m_propertyLimits;
+
+        // Everything the connection needs costs two round trips: extension data,
+        // atoms and the root event mask go out together, then both extension
+        // versions, which can only be asked once the extensions are known to exist
+        Xcb::ClientPidCache::Prefetch(m_xcb);
+        Xcb::RandrMonitors::Prefetch(m_xcb);
+        auto atomCookies = RequestAtoms();
+        xcb_get_window_attributes_cookie_t attrsCookie{};
+        if (selectEvents)
+        {
+            attrsCookie = xcb_get_window_attributes(m_xcb, m_fetch.root);
+        }
+        unsigned int xresVersion = m_pidCache.RequestVersion(m_xcb);
+        unsigned int randrVersion = m_monitors.RequestVersion(m_xcb, m_fetch.root);
+
+        Xcb::ReplyWait wait;
+        CollectAtoms(atomCookies, wait);
+        if (selectEvents)
+        {
+            // Event masks are per client; on a shared connection the host may
+            // already listen on the root, so add to its mask rather than replace it
+            Xcb::Reply<xcb_get_window_attributes_reply_t> attrs(static_cast<xcb_get_window_attributes_reply_t *>(
+                Xcb::WaitForReply(m_xcb, attrsCookie.sequence, wait)));
+            uint32_t current = attrs ? attrs->your_event_mask : 0;
+            if (!(current & XCB_EVENT_MASK_PROPERTY_CHANGE))
+            {
+                const uint32_t rootEvents = current | XCB_EVENT_MASK_PROPERTY_CHANGE;
+                xcb_change_window_attributes(m_xcb, m_fetch.root, XCB_CW_EVENT_MASK, &rootEvents);
+            }
+        }
+        m_pidCache.CompleteInitialize(m_xcb, xresVersion, wait);
+        m_monitors.CompleteInitialize(m_xcb, randrVersion, selectEvents, wait);
+        xcb_flush(m_xcb);
+
+        // DestroyNotify only arrives if selected per window, which is left to
+        // the host on an adopted connection
+        m_tracker.SetTracking(selectEvents && !m_adopted);
+        m_fetch.cache = m_tracker.IsTracking() ? &m_properties : nullptr;
+
+        m_desktopsValid = false;
+        m_ioErrorRaised = false;
+        m_connected = true;
         m_initialized = true;
-        return true;
     }
 
     bool WindowManagerLinux::IsInitialized() const
@@ -55,630 +252,2078 @@ namespace CrossWindow
         return m_initialized;
     }
 
+    bool WindowManagerLinux::IsConnected() const
+    {
+        return m_initialized && m_connected && !m_ioErrorRaised && !xcb_connection_has_error(m_xcb);
+    }
+
     void WindowManagerLinux::Shutdown()
     {
-        if (m_display)
+        m_cgroups.Clear();
+        m_sampler.Clear();
+        CloseConnection();
+        m_initialized = false;
+    }
+
+    void WindowManagerLinux::CloseConnection()
+    {
+        m_pidCache.Reset();
+        m_monitors.Reset();
+        m_tracker.Reset();
+        m_properties.Clear();
+        m_watches.clear();
+        m_watchChanges.clear();
+        for (xcb_connection_t *conn : m_workerConnections)
+        {
+            if (conn)
+            {
+                xcb_disconnect(conn);
+            }
+        }
+        m_workerConnections.clear();
+        if (m_xcb && m_ownsXcb)
+        {
+            xcb_disconnect(m_xcb);
+        }
+        m_xcb = nullptr;
+
+        // An adopted display is left open for the host unless ownership was handed over
+        if (m_display && m_ownsDisplay)
         {
             XCloseDisplay(m_display);
-            m_display = nullptr;
         }
-        m_initialized = false;
+        m_display = nullptr;
+        m_connected = false;
+        m_ioErrorRaised = false;
     }
 
-    void WindowManagerLinux::InitializeAtoms()
+    void WindowManagerLinux::OnIOErrorExit(Display *, void *userData)
     {
-        m_atomNetClientList = XInternAtom(m_display, "_NET_CLIENT_LIST", False);
-        m_atomNetActiveWindow = XInternAtom(m_display, "_NET_ACTIVE_WINDOW", False);
-        m_atomNetWmName = XInternAtom(m_display, "_NET_WM_NAME", False);
-        m_atomNetWmPid = XInternAtom(m_display, "_NET_WM_PID", False);
-        m_atomNetWmState = XInternAtom(m_display, "_NET_WM_STATE", False);
-        m_atomNetWmStateHidden = XInternAtom(m_display, "_NET_WM_STATE_HIDDEN", False);
-        m_atomNetWmStateMaximizedVert = XInternAtom(m_display, "_NET_WM_STATE_MAXIMIZED_VERT", False);
-        m_atomNetWmStateMaximizedHorz = XInternAtom(m_display, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
-        m_atomNetWmStateFullscreen = XInternAtom(m_display, "_NET_WM_STATE_FULLSCREEN", False);
-        m_atomNetWmStateAbove = XInternAtom(m_display, "_NET_WM_STATE_ABOVE", False);
-        m_atomNetCloseWindow = XInternAtom(m_display, "_NET_CLOSE_WINDOW", False);
-        m_atomWmState = XInternAtom(m_display, "WM_STATE", False);
-        m_atomWmChangeState = XInternAtom(m_display, "WM_CHANGE_STATE", False);
-        m_atomUtf8String = XInternAtom(m_display, "UTF8_STRING", False);
-        m_atomWmName = XInternAtom(m_display, "WM_NAME", False);
-        m_atomWmClass = XInternAtom(m_display, "WM_CLASS", False);
-        m_atomNetWmWindowOpacity = XInternAtom(m_display, "_NET_WM_WINDOW_OPACITY", False);
+        static_cast<WindowManagerLinux *>(userData)->m_ioErrorRaised = true;
     }
 
-    std::vector<Window> WindowManagerLinux::GetClientList()
+    ErrorCode WindowManagerLinux::CheckConnection()
     {
-        std::vector<Window> windows;
-
-        Atom actualType;
-        int actualFormat;
-        unsigned long numItems, bytesAfter;
-        unsigned char *data = nullptr;
+        if (!m_initialized)
+        {
+            SetLastError("WindowManager not initialized"_msg);
+            return ErrorCode::NotInitialized;
+        }
 
-        int status = XGetWindowProperty(m_display, m_rootWindow, m_atomNetClientList,
-                                        0, (~0L), False, XA_WINDOW,
-                                        &actualType, &actualFormat, &numItems,
-                                        &bytesAfter, &data);
+        if (m_connected && (m_ioErrorRaised || xcb_connection_has_error(m_xcb)))
+        {
+            // Nothing on the old connection can be trusted, atoms included; the
+            // first attempt to get a new one is made right away
+            CloseConnection();
+            m_nextReconnect = std::chrono::steady_clock::now();
+            m_reconnectDelay = kReconnectInitialDelay;
+        }
 
-        if (status == X11Success && data)
+        if (!m_connected && !Reconnect())
         {
-            Window *windowList = reinterpret_cast<Window *>(data);
-            for (unsigned long i = 0; i < numItems; ++i)
-            {
-                windows.push_back(windowList[i]);
-            }
-            XFree(data);
+            return ErrorCode::NotConnected;
         }
 
-        return windows;
+        // Followed windows keep sending StructureNotify and PropertyChange; taking
+        // them on every call keeps the queue to what arrived since the last one
+        ProcessPendingEvents();
+        return ErrorCode::Success;
     }
 
-    std::string WindowManagerLinux::GetWindowTitleInternal(Window window)
+    bool WindowManagerLinux::Reconnect()
     {
-        std::string title;
+        if (m_adopted)
+        {
+            SetLastError("The adopted X connection was lost; Initialize again with a new one"_msg);
+            return false;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now < m_nextReconnect)
+        {
+            SetLastError("Not connected to the X server; waiting to reconnect"_msg);
+            return false;
+        }
+
+        if (OpenConnection(m_requestedDisplay))
+        {
+            return true;
+        }
 
-        // Try _NET_WM_NAME first (UTF-8)
-        Atom actualType;
-        int actualFormat;
-        unsigned long numItems, bytesAfter;
-        unsigned char *data = nullptr;
+        m_nextReconnect = now + m_reconnectDelay;
+        m_reconnectDelay = std::min(m_reconnectDelay * 2, kReconnectMaxDelay);
+        SetLastError("Not connected to the X server; reconnect failed"_msg);
+        return false;
+    }
 
-        int status = XGetWindowProperty(m_display, window, m_atomNetWmName,
-                                        0, (~0L), False, m_atomUtf8String,
-                                        &actualType, &actualFormat, &numItems,
-                                        &bytesAfter, &data);
+    std::vector<std::pair<const char *, Atom *>> WindowManagerLinux::AtomSlots()
+    {
+        return {
+            {"_NET_CLIENT_LIST", &m_atomNetClientList},
+            {"_NET_ACTIVE_WINDOW", &m_atomNetActiveWindow},
+            {"_NET_WM_NAME", &m_atomNetWmName},
+            {"_NET_WM_PID", &m_atomNetWmPid},
+            {"_NET_WM_STATE", &m_atomNetWmState},
+            {"_NET_WM_STATE_HIDDEN", &m_atomNetWmStateHidden},
+            {"_NET_WM_STATE_MAXIMIZED_VERT", &m_atomNetWmStateMaximizedVert},
+            {"_NET_WM_STATE_MAXIMIZED_HORZ", &m_atomNetWmStateMaximizedHorz},
+            {"_NET_WM_STATE_FULLSCREEN", &m_atomNetWmStateFullscreen},
+            {"_NET_WM_STATE_ABOVE", &m_atomNetWmStateAbove},
+            {"_NET_CLOSE_WINDOW", &m_atomNetCloseWindow},
+            {"WM_STATE", &m_atomWmState},
+            {"WM_CHANGE_STATE", &m_atomWmChangeState},
+            {"UTF8_STRING", &m_atomUtf8String},
+            {"WM_NAME", &m_atomWmName},
+            {"WM_CLASS", &m_atomWmClass},
+            {"_NET_WM_WINDOW_OPACITY", &m_atomNetWmWindowOpacity},
+            {"_NET_WM_DESKTOP", &m_atomNetWmDesktop},
+            {"_NET_CURRENT_DESKTOP", &m_atomNetCurrentDesktop},
+            {"_NET_NUMBER_OF_DESKTOPS", &m_atomNetNumberOfDesktops},
+            {"_NET_WM_WINDOW_TYPE", &m_atomNetWmWindowType},
+            {"_NET_WM_STATE_SKIP_TASKBAR", &m_atomNetWmStateSkipTaskbar},
+            {"_NET_WM_STATE_SKIP_PAGER", &m_atomNetWmStateSkipPager},
+        };
+    }
 
-        if (status == X11Success && data && numItems > 0)
+    std::vector<xcb_intern_atom_cookie_t> WindowManagerLinux::RequestAtoms()
+    {
+        // All names go out at once instead of one round trip per name
+        auto slots = AtomSlots();
+        std::vector<xcb_intern_atom_cookie_t> cookies;
+        cookies.reserve(slots.size() + Xcb::kWindowTypeCount);
+        for (const auto &slot : slots)
+        {
+            cookies.push_back(xcb_intern_atom(m_xcb, 0, static_cast<uint16_t>(std::strlen(slot.first)), slot.first));
+        }
+        for (const char *name : Xcb::kWindowTypeAtomNames)
         {
-            title = std::string(reinterpret_cast<char *>(data), numItems);
-            XFree(data);
-            return title;
+            cookies.push_back(xcb_intern_atom(m_xcb, 0, static_cast<uint16_t>(std::strlen(name)), name));
         }
+        return cookies;
+    }
+
+    void WindowManagerLinux::CollectAtoms(const std::vector<xcb_intern_atom_cookie_t> &cookies, Xcb::ReplyWait &wait)
+    {
+        auto atomAt = [&](size_t i)
+        {
+            Xcb::Reply<xcb_intern_atom_reply_t> reply(
+                static_cast<xcb_intern_atom_reply_t *>(Xcb::WaitForReply(m_xcb, cookies[i].sequence, wait)));
+            return reply ? reply->atom : static_cast<xcb_atom_t>(XCB_NONE);
+        };
 
-        if (data)
-            XFree(data);
+        // The fixed atoms also seed the by-name lookup used for arbitrary properties
+        m_atomsByName.clear();
+        m_atomNames.clear();
+        auto remember = [&](const char *name, xcb_atom_t atom)
+        {
+            if (atom != XCB_NONE)
+            {
+                m_atomsByName[name] = atom;
+                m_atomNames[atom] = name;
+            }
+        };
 
-        // Fall back to WM_NAME
-        char *name = nullptr;
-        if (XFetchName(m_display, window, &name) && name)
+        auto slots = AtomSlots();
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            *slots[i].second = atomAt(i);
+            remember(slots[i].first, static_cast<xcb_atom_t>(*slots[i].second));
+        }
+        for (size_t i = 0; i < Xcb::kWindowTypeCount; ++i)
         {
-            title = name;
-            XFree(name);
+            m_fetch.atoms.windowTypes[i] = atomAt(slots.size() + i);
+            remember(Xcb::kWindowTypeAtomNames[i], m_fetch.atoms.windowTypes[i]);
         }
 
-        return title;
+        m_fetch.atoms.netWmName = static_cast<xcb_atom_t>(m_atomNetWmName);
+        m_fetch.atoms.utf8String = static_cast<xcb_atom_t>(m_atomUtf8String);
+        m_fetch.atoms.netWmPid = static_cast<xcb_atom_t>(m_atomNetWmPid);
+        m_fetch.atoms.netWmState = static_cast<xcb_atom_t>(m_atomNetWmState);
+        m_fetch.atoms.netWmStateHidden = static_cast<xcb_atom_t>(m_atomNetWmStateHidden);
+        m_fetch.atoms.netWmStateMaximizedVert = static_cast<xcb_atom_t>(m_atomNetWmStateMaximizedVert);
+        m_fetch.atoms.netWmStateMaximizedHorz = static_cast<xcb_atom_t>(m_atomNetWmStateMaximizedHorz);
+        m_fetch.atoms.netWmStateFullscreen = static_cast<xcb_atom_t>(m_atomNetWmStateFullscreen);
+        m_fetch.atoms.netWmStateAbove = static_cast<xcb_atom_t>(m_atomNetWmStateAbove);
+        m_fetch.atoms.netWmDesktop = static_cast<xcb_atom_t>(m_atomNetWmDesktop);
+        m_fetch.atoms.netWmWindowType = static_cast<xcb_atom_t>(m_atomNetWmWindowType);
+        m_fetch.atoms.netWmStateSkipTaskbar = static_cast<xcb_atom_t>(m_atomNetWmStateSkipTaskbar);
+        m_fetch.atoms.netWmStateSkipPager = static_cast<xcb_atom_t>(m_atomNetWmStateSkipPager);
     }
 
-    std::string WindowManagerLinux::GetWindowClassInternal(Window window)
+    void WindowManagerLinux::ProcessPendingEvents()
     {
-        XClassHint classHint;
-        if (XGetClassHint(m_display, window, &classHint))
+        // On an adopted connection the events belong to the host
+        if (m_adopted)
+        {
+            return;
+        }
+
+        while (xcb_generic_event_t *event = xcb_poll_for_event(m_xcb))
         {
-            std::string className = classHint.res_class ? classHint.res_class : "";
-            if (classHint.res_name)
-                XFree(classHint.res_name);
-            if (classHint.res_class)
-                XFree(classHint.res_class);
-            return className;
+            DispatchEvent(event);
+            std::free(event);
         }
-        return "";
     }
 
-    uint32_t WindowManagerLinux::GetWindowPidInternal(Window window)
+    bool WindowManagerLinux::DispatchEvent(const xcb_generic_event_t *event)
     {
-        Atom actualType;
-        int actualFormat;
-        unsigned long numItems, bytesAfter;
-        unsigned char *data = nullptr;
+        uint8_t type = event->response_type & 0x7f;
+        if (type == XCB_PROPERTY_NOTIFY)
+        {
+            auto *notify = reinterpret_cast<const xcb_property_notify_event_t *>(event);
+            return HandlePropertyChange(notify->window, notify->atom);
+        }
+        if (type == XCB_DESTROY_NOTIFY)
+        {
+            HandleWindowDestroyed(reinterpret_cast<const xcb_destroy_notify_event_t *>(event)->window);
+            return true;
+        }
+        if (type == 0)
+        {
+            // A BadWindow from a request without a reply (such as selecting
+            // StructureNotify) means the window was gone before DestroyNotify could be asked for
+            auto *error = reinterpret_cast<const xcb_generic_error_t *>(event);
+            if (error->error_code == XCB_WINDOW)
+            {
+                HandleWindowDestroyed(error->resource_id);
+            }
+            return false;
+        }
+        return m_monitors.HandleEvent(type);
+    }
 
-        int status = XGetWindowProperty(m_display, window, m_atomNetWmPid,
-                                        0, 1, False, XA_CARDINAL,
-                                        &actualType, &actualFormat, &numItems,
-                                        &bytesAfter, &data);
+    bool WindowManagerLinux::HandlePropertyChange(xcb_window_t window, xcb_atom_t atom)
+    {
+        // Several notifications for one property before the next poll are delivered once
+        auto change = std::make_pair(window, atom);
+        if (std::any_of(m_watches.begin(), m_watches.end(), [&](const PropertyWatch &w)
+                        { return w.window == window && w.atom == atom; }) &&
+            std::find(m_watchChanges.begin(), m_watchChanges.end(), change) == m_watchChanges.end())
+        {
+            m_watchChanges.push_back(change);
+        }
 
-        uint32_t pid = 0;
-        if (status == X11Success && data && numItems > 0)
+        m_properties.Invalidate(window, atom);
+        if (window != m_fetch.root)
+        {
+            return true;
+        }
+        if (atom == static_cast<xcb_atom_t>(m_atomNetCurrentDesktop) ||
+            atom == static_cast<xcb_atom_t>(m_atomNetNumberOfDesktops))
         {
-            pid = *reinterpret_cast<uint32_t *>(data);
+            m_desktopsValid = false;
+            return true;
         }
+        return false;
+    }
 
-        if (data)
-            XFree(data);
+    void WindowManagerLinux::HandleWindowDestroyed(xcb_window_t window)
+    {
+        m_tracker.Destroyed(window);
+        m_properties.InvalidateWindow(window);
+        m_pidCache.WindowDestroyed(window);
+        m_watches.erase(std::remove_if(m_watches.begin(), m_watches.end(), [&](const PropertyWatch &w)
+                                       { return w.window == window; }),
+                        m_watches.end());
+    }
 
-        return pid;
+    bool WindowManagerLinux::ProcessEvent(const void *event)
+    {
+        if (!m_initialized || !event)
+        {
+            return false;
+        }
+        bool handled = DispatchEvent(static_cast<const xcb_generic_event_t *>(event));
+        DeliverWatches();
+        return handled;
     }
 
-    std::string WindowManagerLinux::GetProcessNameFromPid(uint32_t pid)
+    bool WindowManagerLinux::ProcessXEvent(const void *event)
     {
-        if (pid == 0)
-            return "";
+        if (!m_initialized || !event)
+        {
+            return false;
+        }
 
-        std::string path = "/proc/" + std::to_string(pid) + "/comm";
-        std::ifstream file(path);
-        std::string name;
-        if (file.is_open() && std::getline(file, name))
+        const XEvent *xevent = static_cast<const XEvent *>(event);
+        bool handled = false;
+        if (xevent->type == PropertyNotify)
         {
-            // Remove trailing newline if present
-            if (!name.empty() && name.back() == '\n')
-            {
-                name.pop_back();
-            }
-            return name;
+            handled = HandlePropertyChange(static_cast<xcb_window_t>(xevent->xproperty.window),
+                                           static_cast<xcb_atom_t>(xevent->xproperty.atom));
+        }
+        else if (xevent->type == DestroyNotify)
+        {
+            HandleWindowDestroyed(static_cast<xcb_window_t>(xevent->xdestroywindow.window));
+            handled = true;
+        }
+        else
+        {
+            handled = m_monitors.HandleEvent(static_cast<uint8_t>(xevent->type));
         }
-        return "";
+        DeliverWatches();
+        return handled;
     }
 
-    bool WindowManagerLinux::HasWmState(Window window, Atom state)
+    bool WindowManagerLinux::PollEvents()
     {
-        Atom actualType;
-        int actualFormat;
-        unsigned long numItems, bytesAfter;
-        unsigned char *data = nullptr;
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return false;
+        }
+        ProcessPendingEvents();
+        return DeliverWatches();
+    }
 
-        int status = XGetWindowProperty(m_display, window, m_atomNetWmState,
-                                        0, (~0L), False, XA_ATOM,
-                                        &actualType, &actualFormat, &numItems,
-                                        &bytesAfter, &data);
+    bool WindowManagerLinux::DeliverWatches()
+    {
+        // Callbacks may watch or unwatch, so neither list is iterated while they run
+        std::vector<std::pair<xcb_window_t, xcb_atom_t>> changes;
+        changes.swap(m_watchChanges);
 
-        bool hasState = false;
-        if (status == X11Success && data)
+        bool delivered = false;
+        for (const auto &change : changes)
         {
-            Atom *atoms = reinterpret_cast<Atom *>(data);
-            for (unsigned long i = 0; i < numItems; ++i)
+            std::vector<std::pair<int, PropertyChangeCallback>> targets;
+            std::string atomName;
+            for (const auto &watch : m_watches)
+            {
+                if (watch.window == change.first && watch.atom == change.second)
+                {
+                    targets.emplace_back(watch.id, watch.callback);
+                    atomName = watch.atomName;
+                }
+            }
+            for (auto &target : targets)
             {
-                if (atoms[i] == state)
+                // Skip watches removed by an earlier callback of this batch
+                if (std::any_of(m_watches.begin(), m_watches.end(), [&](const PropertyWatch &w)
+                                { return w.id == target.first; }))
                 {
-                    hasState = true;
-                    break;
+                    target.second(static_cast<NativeHandle>(change.first), atomName);
+                    delivered = true;
                 }
             }
-            XFree(data);
         }
-
-        return hasState;
+        return delivered;
     }
 
-    void WindowManagerLinux::SendClientMessage(Window window, Atom messageType,
-                                               long data0, long data1, long data2,
-                                               long data3, long data4)
+    void WindowManagerLinux::RefreshDesktops(Xcb::ReplyWait &wait)
     {
-        XEvent event;
-        memset(&event, 0, sizeof(event));
-        event.xclient.type = ClientMessage;
-        event.xclient.serial = 0;
-        event.xclient.send_event = True;
-        event.xclient.message_type = messageType;
-        event.xclient.window = window;
-        event.xclient.format = 32;
-        event.xclient.data.l[0] = data0;
-        event.xclient.data.l[1] = data1;
-        event.xclient.data.l[2] = data2;
-        event.xclient.data.l[3] = data3;
-        event.xclient.data.l[4] = data4;
+        ProcessPendingEvents();
+        if (m_desktopsValid)
+        {
+            return;
+        }
 
-        XSendEvent(m_display, m_rootWindow, False,
-                   SubstructureRedirectMask | SubstructureNotifyMask, &event);
-        XFlush(m_display);
+        // Both reads share one round trip
+        xcb_window_t root = m_fetch.root;
+        auto current = xcb_get_property(m_xcb, 0, root, static_cast<xcb_atom_t>(m_atomNetCurrentDesktop),
+                                        XCB_ATOM_CARDINAL, 0, 1);
+        uint32_t count = Xcb::ReadCardinal(m_xcb, root, static_cast<xcb_atom_t>(m_atomNetNumberOfDesktops), 0, wait);
+        Xcb::Reply<xcb_get_property_reply_t> reply(
+            static_cast<xcb_get_property_reply_t *>(Xcb::WaitForReply(m_xcb, current.sequence, wait)));
+        if (wait.timedOut)
+        {
+            return;
+        }
+
+        m_desktopCount = static_cast<int>(count);
+        m_currentDesktop = -1;
+        if (reply && reply->format == 32 && xcb_get_property_value_length(reply.get()) >= 4)
+        {
+            m_currentDesktop = static_cast<int>(*static_cast<const uint32_t *>(xcb_get_property_value(reply.get())));
+        }
+        m_desktopsValid = true;
     }
 
-    void WindowManagerLinux::SetWmState(Window window, bool add, Atom state1, Atom state2)
+    int WindowManagerLinux::GetCurrentDesktop()
     {
-        SendClientMessage(window, m_atomNetWmState,
-                          add ? 1 : 0, // _NET_WM_STATE_ADD = 1, _NET_WM_STATE_REMOVE = 0
-                          static_cast<long>(state1),
-                          static_cast<long>(state2),
-                          1); // Source indication (1 = application)
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return -1;
+        }
+        Xcb::ReplyWait wait;
+        RefreshDesktops(wait);
+        return m_currentDesktop;
     }
 
-    bool WindowManagerLinux::ToLowerCompare(const std::string &str, const std::string &pattern)
+    int WindowManagerLinux::GetDesktopCount()
     {
-        std::string lowerStr = str;
-        std::string lowerPattern = pattern;
-        std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), ::tolower);
-        std::transform(lowerPattern.begin(), lowerPattern.end(), lowerPattern.begin(), ::tolower);
-        return lowerStr.find(lowerPattern) != std::string::npos;
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return 0;
+        }
+        Xcb::ReplyWait wait;
+        RefreshDesktops(wait);
+        return m_desktopCount;
     }
 
-    std::vector<WindowInfo> WindowManagerLinux::GetAllWindows()
+    const std::vector<MonitorInfo> &WindowManagerLinux::RefreshMonitors(Xcb::ReplyWait &wait)
     {
-        std::vector<WindowInfo> result;
+        ProcessPendingEvents();
+        return m_monitors.Get(m_xcb, wait);
+    }
 
-        if (!m_initialized)
+    void WindowManagerLinux::AssignMonitors(std::vector<WindowInfo> &windows, Xcb::ReplyWait &wait)
+    {
+        const auto &monitors = RefreshMonitors(wait);
+        for (auto &info : windows)
         {
-            SetLastError("WindowManager not initialized");
-            return result;
+            info.monitor = Xcb::LargestOverlap(info.rect, monitors);
         }
+    }
 
-        auto windows = GetClientList();
-        for (Window w : windows)
+    bool WindowManagerLinux::ReadGeometry(xcb_window_t window, Rect &rect, bool *visible, Xcb::ReplyWait &wait)
+    {
+        // Over XCB, a window destroyed in the meantime fails the replies; through
+        // Xlib its BadWindow would reach the error handler, which exits by default
+        xcb_get_window_attributes_cookie_t attrsCookie{};
+        if (visible)
+        {
+            attrsCookie = xcb_get_window_attributes(m_xcb, window);
+        }
+        auto geometryCookie = xcb_get_geometry(m_xcb, window);
+        auto positionCookie = xcb_translate_coordinates(m_xcb, window, m_fetch.root, 0, 0);
+
+        Xcb::Reply<xcb_get_window_attributes_reply_t> attrs(
+            visible ? static_cast<xcb_get_window_attributes_reply_t *>(
+                          Xcb::WaitForReply(m_xcb, attrsCookie.sequence, wait))
+                    : nullptr);
+        Xcb::Reply<xcb_get_geometry_reply_t> geometry(
+            static_cast<xcb_get_geometry_reply_t *>(Xcb::WaitForReply(m_xcb, geometryCookie.sequence, wait)));
+        Xcb::Reply<xcb_translate_coordinates_reply_t> position(
+            static_cast<xcb_translate_coordinates_reply_t *>(Xcb::WaitForReply(m_xcb, positionCookie.sequence, wait)));
+        if (!geometry || !position || (visible && !attrs))
         {
-            auto info = GetWindowInfo(w);
-            if (info.ok())
-            {
-                result.push_back(info.value);
-            }
+            return false;
         }
 
-        return result;
+        rect = Rect{position->dst_x, position->dst_y, geometry->width, geometry->height};
+        if (visible)
+        {
+            *visible = attrs->map_state == XCB_MAP_STATE_VIEWABLE;
+        }
+        return true;
     }
 
-    void WindowManagerLinux::EnumerateWindows(const EnumWindowsCallback &callback)
+    bool WindowManagerLinux::FollowWindow(xcb_window_t window)
     {
-        if (!m_initialized)
+        if (!m_tracker.IsTracking())
         {
-            return;
+            return false;
+        }
+        if (m_tracker.Follow(window))
+        {
+            // Event masks are per client, so this does not disturb the owner of
+            // the window; the request is flushed with the batch it belongs to
+            xcb_change_window_attributes(m_xcb, window, XCB_CW_EVENT_MASK, &kFollowedWindowEvents);
+        }
+        return true;
+    }
+
+    void WindowManagerLinux::TrackWindow(WindowInfo &info)
+    {
+        bool isNew = false;
+        xcb_window_t window = static_cast<xcb_window_t>(info.handle);
+        info.generation = m_tracker.Observe(window, info.processId, &isNew);
+        if (isNew && m_tracker.IsTracking())
+        {
+            xcb_change_window_attributes(m_xcb, window, XCB_CW_EVENT_MASK, &kFollowedWindowEvents);
+        }
+    }
+
+    bool WindowManagerLinux::ReadProperty(Window window, Atom property, Atom type, uint32_t length,
+                                          Xcb::PropertyValue &out)
+    {
+        Xcb::ReplyWait wait;
+        return ReadProperty(window, property, type, length, out, wait);
+    }
+
+    bool WindowManagerLinux::ReadProperty(Window window, Atom property, Atom type, uint32_t length,
+                                          Xcb::PropertyValue &out, Xcb::ReplyWait &wait)
+    {
+        xcb_window_t id = static_cast<xcb_window_t>(window);
+        xcb_atom_t atom = static_cast<xcb_atom_t>(property);
+        xcb_atom_t requestedType = static_cast<xcb_atom_t>(type);
+
+        // Notifications already received must invalidate before anything is served
+        ProcessPendingEvents();
+        if (m_properties.Lookup(id, atom, requestedType, length, out))
+        {
+            return true;
+        }
+
+        // Selecting events first means the reply is covered by them from the start
+        bool cacheable = FollowWindow(id);
+        auto cookie = xcb_get_property(m_xcb, 0, id, atom, requestedType, 0, length);
+        Xcb::Reply<xcb_get_property_reply_t> reply(
+            static_cast<xcb_get_property_reply_t *>(Xcb::WaitForReply(m_xcb, cookie.sequence, wait)));
+        out = Xcb::PropertyValue::FromReply(reply.get());
+        if (!reply)
+        {
+            return false;
+        }
+        if (cacheable)
+        {
+            m_properties.Store(id, atom, requestedType, length, reply.get());
+        }
+        return true;
+    }
+
+    std::vector<MonitorInfo> WindowManagerLinux::GetMonitors()
+    {
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return {};
+        }
+        Xcb::ReplyWait wait;
+        return RefreshMonitors(wait);
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsOnMonitor(int monitorIndex)
+    {
+        if (CheckConnection() != ErrorCode::Success || monitorIndex < 0)
+        {
+            return {};
+        }
+
+        auto windows = GetAllWindows();
+        std::vector<WindowInfo> result;
+        for (auto &info : windows)
+        {
+            if (info.monitor == monitorIndex)
+            {
+                result.push_back(std::move(info));
+            }
+        }
+        return result;
+    }
+
+    std::vector<Window> WindowManagerLinux::FilterWindows(const std::vector<Window> &windows,
+                                                          const EnumerationOptions &options,
+                                                          Xcb::ReplyWait &wait)
+    {
+        Xcb::WindowFilter filter;
+        if (options.desktop >= 0)
+        {
+            filter.byDesktop = true;
+            filter.desktop = static_cast<uint32_t>(options.desktop);
+        }
+        else if (options.desktop == CurrentDesktop)
+        {
+            RefreshDesktops(wait);
+            filter.byDesktop = m_currentDesktop >= 0;
+            filter.desktop = static_cast<uint32_t>(std::max(m_currentDesktop, 0));
+        }
+
+        filter.excludeTypes = options.excludeTypes;
+        filter.excludeSkipTaskbar = options.excludeSkipTaskbar;
+        filter.excludeSkipPager = options.excludeSkipPager;
+
+        if (!filter.IsActive())
+        {
+            return windows;
+        }
+
+        std::vector<xcb_window_t> ids(windows.begin(), windows.end());
+        auto kept = Xcb::FilterWindows(m_xcb, m_fetch, ids.data(), ids.size(), filter, wait);
+        return std::vector<Window>(kept.begin(), kept.end());
+    }
+
+    std::vector<Window> WindowManagerLinux::GetClientList(Xcb::ReplyWait &wait)
+    {
+        // Keep the event queue short even if no cached state is ever asked for
+        ProcessPendingEvents();
+
+        xcb_window_t root = static_cast<xcb_window_t>(m_rootWindow);
+        std::vector<xcb_window_t> ids;
+
+        if (Xcb::ReadClientList(m_xcb, root, static_cast<xcb_atom_t>(m_atomNetClientList),
+                                m_propertyLimits.maxClientListWindows, wait, ids, &m_clientListTruncated))
+        {
+            m_lastStrategy = EnumerationStrategy::ClientList;
+        }
+        else
+        {
+            // No EWMH window manager: find clients by walking the tree for WM_STATE
+            m_lastStrategy = EnumerationStrategy::TreeWalk;
+            m_clientListTruncated = false;
+            ids = Xcb::WalkClientTree(m_xcb, root, static_cast<xcb_atom_t>(m_atomWmState), wait);
+        }
+
+        // Clients whose witness left the list may have passed their id on
+        if (!wait.timedOut)
+        {
+            m_pidCache.Retain(ids.data(), ids.size());
+        }
+        return std::vector<Window>(ids.begin(), ids.end());
+    }
+
+    std::string WindowManagerLinux::GetWindowTitleInternal(Window window, bool *truncated)
+    {
+        Xcb::ReplyWait wait;
+        return GetWindowTitleInternal(window, truncated, wait);
+    }
+
+    std::string WindowManagerLinux::GetWindowTitleInternal(Window window, bool *truncated, Xcb::ReplyWait &wait)
+    {
+        std::string title;
+        const uint32_t maxBytes = m_propertyLimits.maxTitleBytes;
+        const uint32_t length = LengthFor(maxBytes);
+
+        // Try _NET_WM_NAME first (UTF-8), then WM_NAME (Latin-1); both capped at maxTitleBytes
+        Xcb::PropertyValue value;
+        xcb_atom_t requested = XCB_NONE;
+        if (ReadProperty(window, m_atomNetWmName, m_atomUtf8String, length, value, wait) && !value.data.empty())
+        {
+            requested = static_cast<xcb_atom_t>(m_atomUtf8String);
+            title.assign(value.As<char>(), value.data.size());
+        }
+        else if (ReadProperty(window, m_atomWmName, XA_STRING, length, value, wait))
+        {
+            requested = XCB_ATOM_STRING;
+            if (value.format == 8)
+            {
+                title.assign(value.As<char>(), value.data.size());
+                title.resize(std::min(title.size(), title.find('\0')));
+            }
+        }
+
+        bool cut = requested != XCB_NONE &&
+                   Xcb::TitleCut(value.type, requested, value.bytesAfter, maxBytes, title);
+        if (truncated)
+        {
+            *truncated = cut;
+        }
+
+        return title;
+    }
+
+    std::string WindowManagerLinux::GetWindowClassInternal(Window window)
+    {
+        // Read WM_CLASS directly rather than XGetClassHint so the size stays capped
+        Xcb::PropertyValue value;
+        std::string className;
+        if (ReadProperty(window, m_atomWmClass, XA_STRING, LengthFor(m_propertyLimits.maxClassBytes), value) &&
+            value.format == 8)
+        {
+            // WM_CLASS holds "res_name\0res_class\0"; the class is the second string
+            std::string text(value.As<char>(), value.data.size());
+            size_t split = text.find('\0');
+            if (split != std::string::npos)
+            {
+                className = text.c_str() + split + 1;
+            }
+        }
+
+        return className;
+    }
+
+    uint32_t WindowManagerLinux::GetWindowPidInternal(Window window)
+    {
+        Xcb::ReplyWait wait;
+        return GetWindowPidInternal(window, wait);
+    }
+
+    uint32_t WindowManagerLinux::GetWindowPidInternal(Window window, Xcb::ReplyWait &wait)
+    {
+        Xcb::PropertyValue value;
+        uint32_t pid = 0;
+        if (ReadProperty(window, m_atomNetWmPid, XA_CARDINAL, 1, value, wait) && value.format == 32 &&
+            value.Count() > 0)
+        {
+            pid = value.As<uint32_t>()[0];
+        }
+
+        if (pid == 0 && !wait.failed && !wait.timedOut)
+        {
+            pid = GetClientPid(window, wait);
+        }
+
+        return pid;
+    }
+
+    uint32_t WindowManagerLinux::GetClientPid(Window window, Xcb::ReplyWait &wait)
+    {
+        if (!m_pidCache.IsAvailable())
+        {
+            return 0;
+        }
+
+        // On a miss, ask about every client on the list in the same request, so
+        // the windows read next find their PID cached instead of costing a round trip each
+        xcb_window_t id = static_cast<xcb_window_t>(window);
+        if (!m_pidCache.IsCached(id))
+        {
+            std::vector<Window> clients = GetClientList(wait);
+            std::vector<xcb_window_t> ids(clients.begin(), clients.end());
+            ids.push_back(id);
+            auto pending = m_pidCache.Request(m_xcb, ids.data(), ids.size());
+            m_pidCache.Collect(m_xcb, pending, wait);
+        }
+        return m_pidCache.Lookup(id);
+    }
+
+    int WindowManagerLinux::GetWindowDesktopInternal(Window window)
+    {
+        Xcb::PropertyValue value;
+        int desktop = -1;
+        if (ReadProperty(window, m_atomNetWmDesktop, XA_CARDINAL, 1, value) && value.format == 32 &&
+            value.Count() > 0)
+        {
+            uint32_t index = value.As<uint32_t>()[0];
+            desktop = index == 0xFFFFFFFFu ? -1 : static_cast<int>(index);
+        }
+
+        return desktop;
+    }
+
+    void WindowManagerLinux::GetWindowTypeInternal(Window window, WindowInfo &info)
+    {
+        Xcb::PropertyValue types;
+        ReadProperty(window, m_atomNetWmWindowType, XA_ATOM, m_propertyLimits.maxStateAtoms, types);
+        info.type = Xcb::WindowTypeFromAtoms(types.As<xcb_atom_t>(), types.format == 32 ? types.Count() : 0,
+                                             m_fetch.atoms);
+
+        // Shares its cache entry with GetWindowStateInternal
+        Xcb::PropertyValue states;
+        if (ReadProperty(window, m_atomNetWmState, XA_ATOM, m_propertyLimits.maxStateAtoms, states) &&
+            states.format == 32)
+        {
+            const xcb_atom_t *list = states.As<xcb_atom_t>();
+            for (size_t i = 0; i < states.Count(); ++i)
+            {
+                if (list[i] == static_cast<xcb_atom_t>(m_atomNetWmStateSkipTaskbar))
+                    info.skipTaskbar = true;
+                else if (list[i] == static_cast<xcb_atom_t>(m_atomNetWmStateSkipPager))
+                    info.skipPager = true;
+            }
+        }
+    }
+
+    std::string WindowManagerLinux::GetProcessNameFromPid(uint32_t pid)
+    {
+        std::string name;
+        if (pid == 0 || !Proc::ReadFile(pid, "comm", name))
+            return "";
+
+        // Remove trailing newline if present
+        if (!name.empty() && name.back() == '\n')
+        {
+            name.pop_back();
+        }
+        return name;
+    }
+
+    void WindowManagerLinux::FillProcessNames(std::vector<WindowInfo> &windows)
+    {
+        // One comm read per distinct process, all in a single batch
+        std::unordered_map<uint32_t, size_t> slotOfPid;
+        std::vector<uint32_t> pids;
+        for (const auto &info : windows)
+        {
+            if (info.processId != 0 && slotOfPid.emplace(info.processId, pids.size()).second)
+            {
+                pids.push_back(info.processId);
+            }
+        }
+
+        std::vector<std::string> names(pids.size());
+        std::vector<Proc::ReadRequest> requests(pids.size());
+        for (size_t i = 0; i < pids.size(); ++i)
+        {
+            requests[i] = {pids[i], "comm", &names[i]};
+        }
+        m_procReader.Read(requests);
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (!requests[i].ok)
+            {
+                names[i].clear();
+            }
+            else if (!names[i].empty() && names[i].back() == '\n')
+            {
+                names[i].pop_back();
+            }
+        }
+
+        std::vector<StringId> nameIds;
+        nameIds.reserve(names.size());
+        for (const auto &name : names)
+        {
+            nameIds.push_back(StringPool::Intern(name));
+        }
+
+        for (auto &info : windows)
+        {
+            auto it = slotOfPid.find(info.processId);
+            if (it != slotOfPid.end())
+            {
+                info.processName = names[it->second];
+                info.processNameId = nameIds[it->second];
+            }
+        }
+    }
+
+    WindowState WindowManagerLinux::GetWindowStateInternal(Window window)
+    {
+        // One capped read of _NET_WM_STATE, decoded for every flag we report
+        Xcb::PropertyValue value;
+        WindowState state = WindowState::Normal;
+        if (ReadProperty(window, m_atomNetWmState, XA_ATOM, m_propertyLimits.maxStateAtoms, value) &&
+            value.format == 32)
+        {
+            const xcb_atom_t *atoms = value.As<xcb_atom_t>();
+            bool maxVert = false;
+            bool maxHorz = false;
+            for (size_t i = 0; i < value.Count(); ++i)
+            {
+                if (atoms[i] == m_atomNetWmStateHidden)
+                    state = state | WindowState::Minimized;
+                else if (atoms[i] == m_atomNetWmStateMaximizedVert)
+                    maxVert = true;
+                else if (atoms[i] == m_atomNetWmStateMaximizedHorz)
+                    maxHorz = true;
+                else if (atoms[i] == m_atomNetWmStateFullscreen)
+                    state = state | WindowState::Fullscreen;
+                else if (atoms[i] == m_atomNetWmStateAbove)
+                    state = state | WindowState::AlwaysOnTop;
+            }
+            if (maxVert && maxHorz)
+            {
+                state = state | WindowState::Maximized;
+            }
+        }
+
+        return state;
+    }
+
+    void WindowManagerLinux::SendClientMessage(Window window, Atom messageType,
+                                               long data0, long data1, long data2,
+                                               long data3, long data4)
+    {
+        QueueClientMessage(window, messageType, data0, data1, data2, data3, data4);
+        XFlush(m_display);
+    }
+
+    void WindowManagerLinux::QueueClientMessage(Window window, Atom messageType,
+                                                long data0, long data1, long data2,
+                                                long data3, long data4)
+    {
+        XEvent event;
+        memset(&event, 0, sizeof(event));
+        event.xclient.type = ClientMessage;
+        event.xclient.serial = 0;
+        event.xclient.send_event = True;
+        event.xclient.message_type = messageType;
+        event.xclient.window = window;
+        event.xclient.format = 32;
+        event.xclient.data.l[0] = data0;
+        event.xclient.data.l[1] = data1;
+        event.xclient.data.l[2] = data2;
+        event.xclient.data.l[3] = data3;
+        event.xclient.data.l[4] = data4;
+
+        XSendEvent(m_display, m_rootWindow, False,
+                   SubstructureRedirectMask | SubstructureNotifyMask, &event);
+    }
+
+    void WindowManagerLinux::SetWmState(Window window, bool add, Atom state1, Atom state2)
+    {
+        SendClientMessage(window, m_atomNetWmState,
+                          add ? 1 : 0, // _NET_WM_STATE_ADD = 1, _NET_WM_STATE_REMOVE = 0
+                          static_cast<long>(state1),
+                          static_cast<long>(state2),
+                          1); // Source indication (1 = application)
+    }
+
+    bool WindowManagerLinux::ToLowerCompare(const std::string &str, const std::string &pattern)
+    {
+        std::string lowerStr = str;
+        std::string lowerPattern = pattern;
+        std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), ::tolower);
+        std::transform(lowerPattern.begin(), lowerPattern.end(), lowerPattern.begin(), ::tolower);
+        return lowerStr.find(lowerPattern) != std::string::npos;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FetchWindows(const std::vector<Window> &windows,
+                                                             unsigned int workerCount,
+                                                             Xcb::ReplyWait &wait)
+    {
+        // Fewer windows than this per worker are not worth another connection
+        constexpr size_t kMinWindowsPerWorker = 128;
+
+        std::vector<xcb_window_t> ids(windows.begin(), windows.end());
+        std::vector<Xcb::FetchedWindow> fetched(ids.size());
+        xcb_window_t root = static_cast<xcb_window_t>(m_rootWindow);
+        for (xcb_window_t id : ids)
+        {
+            FollowWindow(id);
+        }
+        // Which windows lack _NET_WM_PID is only known once their replies arrive, so
+        // every uncached client is asked for up front; the reply rides the same pipeline
+        auto pidQuery = m_pidCache.Request(m_xcb, ids.data(), ids.size());
+        xcb_window_t focused = Xcb::GetActiveWindow(m_xcb, root, static_cast<xcb_atom_t>(m_atomNetActiveWindow), wait);
+
+        size_t workers = std::max<size_t>(1, std::min<size_t>(workerCount, ids.size() / kMinWindowsPerWorker));
+        if (workers <= 1)
+        {
+            Xcb::FetchWindowInfo(m_xcb, m_fetch, focused, ids.data(), ids.size(), fetched.data(), wait);
+        }
+        else
+        {
+            // Contiguous shards, each fetched over its own connection so replies are
+            // decoded on several threads; writing into disjoint slices keeps the order.
+            // Each worker owns one slot of the pool, so slots are opened without locking
+            if (m_workerConnections.size() < workers)
+            {
+                m_workerConnections.resize(workers, nullptr);
+            }
+            std::vector<char> shardDone(workers, 0);
+            std::vector<char> shardTimedOut(workers, 0);
+            std::vector<std::thread> threads;
+            threads.reserve(workers);
+            // Events are selected on the main connection, which orders nothing
+            // on the worker connections, so their replies are not cached
+            Xcb::FetchContext shardContext = m_fetch;
+            shardContext.cache = nullptr;
+            for (size_t w = 0; w < workers; ++w)
+            {
+                size_t begin = ids.size() * w / workers;
+                size_t end = ids.size() * (w + 1) / workers;
+                threads.emplace_back([&, w, begin, end]()
+                                     {
+                                         xcb_connection_t *&conn = m_workerConnections[w];
+                                         if (conn && xcb_connection_has_error(conn))
+                                         {
+                                             xcb_disconnect(conn);
+                                             conn = nullptr;
+                                         }
+                                         if (!conn)
+                                         {
+                                             conn = xcb_connect(m_displayName.c_str(), nullptr);
+                                         }
+                                         if (!xcb_connection_has_error(conn))
+                                         {
+                                             // Nothing is selected here; what queues up is errors
+                                             // for windows destroyed mid-fetch
+                                             while (xcb_generic_event_t *event = xcb_poll_for_event(conn))
+                                             {
+                                                 std::free(event);
+                                             }
+                                             Xcb::ReplyWait shardWait{wait.deadline};
+                                             Xcb::FetchWindowInfo(conn, shardContext, focused,
+                                                                  ids.data() + begin, end - begin,
+                                                                  fetched.data() + begin, shardWait);
+                                             shardTimedOut[w] = shardWait.timedOut;
+                                             shardDone[w] = 1;
+                                         }
+                                     });
+            }
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+
+            // A worker that could not connect leaves its shard to the main connection
+            for (size_t w = 0; w < workers; ++w)
+            {
+                if (shardTimedOut[w])
+                {
+                    wait.timedOut = true;
+                }
+                else if (!shardDone[w])
+                {
+                    size_t begin = ids.size() * w / workers;
+                    size_t end = ids.size() * (w + 1) / workers;
+                    Xcb::FetchWindowInfo(m_xcb, m_fetch, focused,
+                                         ids.data() + begin, end - begin, fetched.data() + begin, wait);
+                }
+            }
+        }
+
+        m_pidCache.Collect(m_xcb, pidQuery, wait);
+
+        std::vector<WindowInfo> result;
+        result.reserve(fetched.size());
+        for (auto &f : fetched)
+        {
+            if (f.valid)
+            {
+                if (f.info.processId == 0)
+                {
+                    f.info.processId = m_pidCache.Lookup(static_cast<xcb_window_t>(f.info.handle));
+                }
+                result.push_back(std::move(f.info));
+            }
+        }
+        FillProcessNames(result);
+        AssignMonitors(result, wait);
+        for (auto &info : result)
+        {
+            TrackWindow(info);
+        }
+        xcb_flush(m_xcb);
+        return result;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::GetAllWindows()
+    {
+        return GetAllWindows(EnumerationOptions{});
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::GetAllWindows(const EnumerationOptions &options)
+    {
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return {};
+        }
+
+        Xcb::ReplyWait wait{options.deadline};
+        auto windows = FilterWindows(GetClientList(wait), options, wait);
+        auto result = FetchWindows(windows, options.workerCount, wait);
+        if (options.includeCgroup)
+        {
+            AttachCgroups(result);
+        }
+        m_lastPartial = m_clientListTruncated || wait.timedOut || xcb_connection_has_error(m_xcb);
+        return result;
+    }
+
+    void WindowManagerLinux::AttachCgroups(std::vector<WindowInfo> &windows)
+    {
+        // One refresh per pass: each distinct process is checked once, however
+        // many windows it owns
+        std::vector<uint32_t> pids;
+        pids.reserve(windows.size());
+        for (const auto &info : windows)
+        {
+            pids.push_back(info.processId);
+        }
+        m_cgroups.Refresh(pids, m_procReader);
+
+        for (auto &info : windows)
+        {
+            if (const CgroupInfo *cgroup = m_cgroups.Find(info.processId))
+            {
+                info.cgroupPath = cgroup->path;
+                info.cgroupUnit = cgroup->unit;
+                info.containerId = cgroup->containerId;
+            }
+        }
+    }
+
+    void WindowManagerLinux::RefreshCgroups(const std::vector<xcb_window_t> &windows,
+                                            Xcb::ClientPidCache::Pending &pidQuery, Xcb::ReplyWait &wait)
+    {
+        // The stream learns each PID only as its window arrives, so read
+        // _NET_WM_PID for the whole pass first; one round trip for all of them
+        std::vector<xcb_get_property_cookie_t> cookies;
+        cookies.reserve(windows.size());
+        for (xcb_window_t window : windows)
+        {
+            cookies.push_back(xcb_get_property(m_xcb, 0, window, static_cast<xcb_atom_t>(m_atomNetWmPid),
+                                               XCB_ATOM_CARDINAL, 0, 1));
+        }
+        m_pidCache.Collect(m_xcb, pidQuery, wait);
+
+        std::vector<uint32_t> pids;
+        pids.reserve(windows.size());
+        for (size_t i = 0; i < windows.size(); ++i)
+        {
+            Xcb::Reply<xcb_get_property_reply_t> reply(
+                static_cast<xcb_get_property_reply_t *>(Xcb::WaitForReply(m_xcb, cookies[i].sequence, wait)));
+            uint32_t pid = 0;
+            if (reply && reply->format == 32 && xcb_get_property_value_length(reply.get()) >= 4)
+            {
+                pid = *static_cast<const uint32_t *>(xcb_get_property_value(reply.get()));
+            }
+            pids.push_back(pid ? pid : m_pidCache.Lookup(windows[i]));
+        }
+        m_cgroups.Refresh(pids, m_procReader);
+    }
+
+    void WindowManagerLinux::EnumerateWindows(WindowCallbackRef callback)
+    {
+        EnumerateWindows(callback, EnumerationOptions{});
+    }
+
+    void WindowManagerLinux::EnumerateWindows(WindowCallbackRef callback,
+                                              const EnumerationOptions &options)
+    {
+        StreamWindows([&callback](WindowInfo &info)
+                      { return callback(info); },
+                      options);
+    }
+
+    void WindowManagerLinux::EnumerateWindowBatches(WindowBatchCallbackRef callback,
+                                                    const EnumerationOptions &options)
+    {
+        // The pipeline refills its WindowInfo from scratch, so each one can be moved into the batch
+        const size_t batchSize = std::max(1u, options.batchSize);
+        std::vector<WindowInfo> batch;
+        batch.reserve(batchSize);
+        bool stopped = false;
+        StreamWindows([&](WindowInfo &info)
+                      {
+                          batch.push_back(std::move(info));
+                          if (batch.size() < batchSize)
+                          {
+                              return true;
+                          }
+                          stopped = !callback(batch.data(), batch.size());
+                          batch.clear();
+                          return !stopped;
+                      },
+                      options);
+        if (!stopped && !batch.empty())
+        {
+            callback(batch.data(), batch.size());
+        }
+    }
+
+    void WindowManagerLinux::StreamWindows(FunctionRef<bool(WindowInfo &)> onWindow,
+                                           const EnumerationOptions &options)
+    {
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return;
+        }
+
+        Xcb::ReplyWait wait{options.deadline};
+        xcb_window_t root = static_cast<xcb_window_t>(m_rootWindow);
+        auto windows = FilterWindows(GetClientList(wait), options, wait);
+        const std::vector<MonitorInfo> monitors = RefreshMonitors(wait);
+        std::vector<xcb_window_t> ids(windows.begin(), windows.end());
+        for (xcb_window_t id : ids)
+        {
+            FollowWindow(id);
+        }
+        auto pidQuery = m_pidCache.Request(m_xcb, ids.data(), ids.size());
+        xcb_window_t focused = Xcb::GetActiveWindow(m_xcb, root, static_cast<xcb_atom_t>(m_atomNetActiveWindow), wait);
+        if (options.includeCgroup)
+        {
+            RefreshCgroups(ids, pidQuery, wait);
+        }
+
+        std::unordered_map<uint32_t, std::pair<std::string, StringId>> names;
+        Xcb::StreamWindowInfo(m_xcb, m_fetch, focused, ids.data(), ids.size(),
+                              options.windowAhead, wait,
+                              [&](WindowInfo &info)
+                              {
+                                  // Sent before any window request, so already answered by now
+                                  m_pidCache.Collect(m_xcb, pidQuery, wait);
+                                  if (info.processId == 0)
+                                  {
+                                      info.processId = m_pidCache.Lookup(static_cast<xcb_window_t>(info.handle));
+                                  }
+                                  // Each process is read and interned once per pass, however many windows it owns
+                                  auto name = names.find(info.processId);
+                                  if (name == names.end())
+                                  {
+                                      std::string processName = GetProcessNameFromPid(info.processId);
+                                      StringId id = StringPool::Intern(processName);
+                                      name = names.emplace(info.processId, std::make_pair(std::move(processName), id)).first;
+                                  }
+                                  info.processName = name->second.first;
+                                  info.processNameId = name->second.second;
+                                  info.monitor = Xcb::LargestOverlap(info.rect, monitors);
+                                  TrackWindow(info);
+                                  if (options.includeCgroup)
+                                  {
+                                      // Refreshed above; only a PID that changed since reads /proc here
+                                      const CgroupInfo *cgroup = m_cgroups.Find(info.processId);
+                                      if (!cgroup)
+                                      {
+                                          cgroup = m_cgroups.Lookup(info.processId);
+                                      }
+                                      if (cgroup)
+                                      {
+                                          info.cgroupPath = cgroup->path;
+                                          info.cgroupUnit = cgroup->unit;
+                                          info.containerId = cgroup->containerId;
+                                      }
+                                  }
+                                  return onWindow(info);
+                              });
+        m_pidCache.Discard(m_xcb, pidQuery);
+        xcb_flush(m_xcb);
+        m_lastPartial = m_clientListTruncated || wait.timedOut || xcb_connection_has_error(m_xcb);
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByTitle(const std::string &titlePattern,
+                                                                   bool caseSensitive)
+    {
+        return FindWindowsByTitle(titlePattern, caseSensitive, NoDeadline);
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByProcess(const std::string &processName)
+    {
+        return FindWindowsByProcess(processName, NoDeadline);
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByTitle(const std::string &titlePattern,
+                                                                   bool caseSensitive, Deadline deadline)
+    {
+        // One pipelined pass instead of a title read per window and a full read per match
+        std::vector<WindowInfo> result;
+        EnumerationOptions options;
+        options.deadline = deadline;
+        StreamWindows([&](WindowInfo &info)
+                      {
+                          bool matches = caseSensitive ? info.title.find(titlePattern) != std::string::npos
+                                                       : ToLowerCompare(info.title, titlePattern);
+                          if (matches)
+                          {
+                              result.push_back(std::move(info));
+                          }
+                          return true;
+                      },
+                      options);
+        return result;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByProcess(const std::string &processName,
+                                                                     Deadline deadline)
+    {
+        std::vector<WindowInfo> result;
+        EnumerationOptions options;
+        options.deadline = deadline;
+        StreamWindows([&](WindowInfo &info)
+                      {
+                          if (ToLowerCompare(info.processName, processName))
+                          {
+                              result.push_back(std::move(info));
+                          }
+                          return true;
+                      },
+                      options);
+        return result;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByCgroup(const std::string &pattern)
+    {
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return {};
+        }
+
+        EnumerationOptions options;
+        options.includeCgroup = true;
+        auto windows = GetAllWindows(options);
+
+        std::vector<WindowInfo> result;
+        for (auto &info : windows)
+        {
+            if (!info.cgroupPath.empty() && info.cgroupPath.find(pattern) != std::string::npos)
+            {
+                result.push_back(std::move(info));
+            }
+        }
+        return result;
+    }
+
+    std::vector<ApplicationGroup> WindowManagerLinux::GroupWindowsByApplication()
+    {
+        auto windows = GetAllWindows();
+
+        std::vector<uint32_t> pids;
+        pids.reserve(windows.size());
+        for (const auto &info : windows)
+        {
+            pids.push_back(info.processId);
+        }
+        m_processTree.Build(pids, m_procReader);
+
+        std::vector<ApplicationGroup> groups;
+        std::unordered_map<uint32_t, size_t> groupOfRoot;
+        for (auto &info : windows)
+        {
+            uint32_t root = m_processTree.ApplicationRoot(info.processId);
+            auto it = groupOfRoot.find(root);
+            if (it == groupOfRoot.end())
+            {
+                it = groupOfRoot.emplace(root, groups.size()).first;
+                ApplicationGroup group;
+                group.rootProcessId = root;
+                group.rootProcessName = root == info.processId ? info.processName : m_processTree.Name(root);
+                groups.push_back(std::move(group));
+            }
+            groups[it->second].windows.push_back(std::move(info));
+        }
+        return groups;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::WindowsOfProcessTree(uint32_t rootProcessId)
+    {
+        auto windows = GetAllWindows();
+
+        std::vector<uint32_t> pids;
+        pids.reserve(windows.size());
+        for (const auto &info : windows)
+        {
+            pids.push_back(info.processId);
+        }
+        m_processTree.Build(pids, m_procReader);
+
+        std::vector<WindowInfo> result;
+        for (auto &info : windows)
+        {
+            if (info.processId != 0 && m_processTree.IsInTree(info.processId, rootProcessId))
+            {
+                result.push_back(std::move(info));
+            }
+        }
+        return result;
+    }
+
+    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByProcessTree(uint32_t rootProcessId)
+    {
+        if (CheckConnection() != ErrorCode::Success || rootProcessId == 0)
+        {
+            return {};
+        }
+        return WindowsOfProcessTree(rootProcessId);
+    }
+
+    Result<WindowInfo> WindowManagerLinux::GetWindowInfo(NativeHandle handle)
+    {
+        Result<WindowInfo> result;
+        Window window = static_cast<Window>(handle);
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        if (!IsValidWindow(handle))
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+            return result;
+        }
+
+        result.value.handle = handle;
+        result.value.title = GetWindowTitleInternal(window, &result.value.titleTruncated);
+        result.value.className = GetWindowClassInternal(window);
+        result.value.classNameId = StringPool::Intern(result.value.className);
+        result.value.processId = GetWindowPidInternal(window);
+        result.value.processName = GetProcessNameFromPid(result.value.processId);
+        result.value.processNameId = StringPool::Intern(result.value.processName);
+
+        // Get geometry
+        Xcb::ReplyWait wait;
+        if (ReadGeometry(static_cast<xcb_window_t>(window), result.value.rect, &result.value.isVisible, wait))
+        {
+            result.value.monitor = Xcb::LargestOverlap(result.value.rect, RefreshMonitors(wait));
+        }
+        TrackWindow(result.value);
+        xcb_flush(m_xcb);
+
+        // Get state
+        result.value.state = GetWindowStateInternal(window);
+        result.value.desktop = GetWindowDesktopInternal(window);
+        GetWindowTypeInternal(window, result.value);
+
+        // Check if focused
+        Window focusedWindow = static_cast<Window>(GetFocusedWindow());
+        if (focusedWindow == window)
+        {
+            result.value.state = result.value.state | WindowState::Focused;
+        }
+
+        result.error = ErrorCode::Success;
+        return result;
+    }
+
+    Result<std::string> WindowManagerLinux::GetWindowTitle(NativeHandle handle)
+    {
+        Result<std::string> result;
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        if (!IsValidWindow(handle))
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+            return result;
+        }
+
+        result.value = GetWindowTitleInternal(static_cast<Window>(handle));
+        result.error = ErrorCode::Success;
+        return result;
+    }
+
+    Result<Rect> WindowManagerLinux::GetWindowRect(NativeHandle handle)
+    {
+        Result<Rect> result;
+        Window window = static_cast<Window>(handle);
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        if (!IsValidWindow(handle))
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+            return result;
+        }
+
+        Xcb::ReplyWait wait;
+        if (ReadGeometry(static_cast<xcb_window_t>(window), result.value, nullptr, wait))
+        {
+            result.error = ErrorCode::Success;
+        }
+        else
+        {
+            result.error = ErrorCode::OperationFailed;
+            result.errorMessage = "Failed to get window attributes"_msg;
+        }
+
+        return result;
+    }
+
+    Result<WindowState> WindowManagerLinux::GetWindowState(NativeHandle handle)
+    {
+        Result<WindowState> result;
+        Window window = static_cast<Window>(handle);
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        if (!IsValidWindow(handle))
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+            return result;
+        }
+
+        result.value = GetWindowStateInternal(window);
+
+        Window focusedWindow = static_cast<Window>(GetFocusedWindow());
+        if (focusedWindow == window)
+        {
+            result.value = result.value | WindowState::Focused;
+        }
+
+        result.error = ErrorCode::Success;
+        return result;
+    }
+
+    Result<uint32_t> WindowManagerLinux::GetWindowProcessId(NativeHandle handle)
+    {
+        Result<uint32_t> result;
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        if (!IsValidWindow(handle))
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+            return result;
+        }
+
+        result.value = GetWindowPidInternal(static_cast<Window>(handle));
+        result.error = ErrorCode::Success;
+        return result;
+    }
+
+    Result<WindowInfo> WindowManagerLinux::FetchWindowInfoUntil(NativeHandle handle, Deadline deadline)
+    {
+        Result<WindowInfo> result;
+
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        // Window requests and the active-window read share a single round trip
+        Xcb::ReplyWait wait{deadline};
+        xcb_window_t root = static_cast<xcb_window_t>(m_rootWindow);
+        xcb_window_t id = static_cast<xcb_window_t>(handle);
+        FollowWindow(id);
+        auto pidQuery = m_pidCache.Request(m_xcb, &id, 1);
+        auto cookies = Xcb::RequestWindowInfo(m_xcb, id, m_fetch);
+        xcb_window_t focused = Xcb::GetActiveWindow(m_xcb, root, static_cast<xcb_atom_t>(m_atomNetActiveWindow), wait);
+        m_pidCache.Collect(m_xcb, pidQuery, wait);
+        bool valid = Xcb::CollectWindowInfo(m_xcb, cookies, m_fetch, focused, result.value, wait);
+        if (valid && result.value.processId == 0)
+        {
+            result.value.processId = m_pidCache.Lookup(id);
+        }
+        if (valid)
+        {
+            result.value.monitor = Xcb::LargestOverlap(result.value.rect, RefreshMonitors(wait));
+            TrackWindow(result.value);
+            xcb_flush(m_xcb);
+        }
+
+        if (wait.timedOut)
+        {
+            result.error = ErrorCode::Timeout;
+            result.errorMessage = "Timed out waiting for the X server"_msg;
+        }
+        else if (!valid)
+        {
+            result.error = ErrorCode::InvalidHandle;
+            result.errorMessage = "Invalid window handle"_msg;
+        }
+        else
+        {
+            result.error = ErrorCode::Success;
+        }
+        return result;
+    }
+
+    Result<WindowInfo> WindowManagerLinux::GetWindowInfo(NativeHandle handle, Deadline deadline)
+    {
+        auto result = FetchWindowInfoUntil(handle, deadline);
+        if (result.ok())
+        {
+            result.value.processName = GetProcessNameFromPid(result.value.processId);
+            result.value.processNameId = StringPool::Intern(result.value.processName);
+        }
+        return result;
+    }
+
+    Result<std::string> WindowManagerLinux::GetWindowTitle(NativeHandle handle, Deadline deadline)
+    {
+        Result<std::string> result;
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        // Only the title properties are read; a destroyed window fails the first of them
+        Xcb::ReplyWait wait{deadline};
+        result.value = GetWindowTitleInternal(static_cast<Window>(handle), nullptr, wait);
+        SetDeadlineError(result, wait);
+        return result;
+    }
+
+    Result<Rect> WindowManagerLinux::GetWindowRect(NativeHandle handle, Deadline deadline)
+    {
+        Result<Rect> result;
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        // Size and root position in one round trip, as the enumeration pipeline computes them
+        Xcb::ReplyWait wait{deadline};
+        if (!ReadGeometry(static_cast<xcb_window_t>(handle), result.value, nullptr, wait))
+        {
+            wait.failed = true;
+        }
+        SetDeadlineError(result, wait);
+        return result;
+    }
+
+    Result<WindowState> WindowManagerLinux::GetWindowState(NativeHandle handle, Deadline deadline)
+    {
+        auto info = FetchWindowInfoUntil(handle, deadline);
+        return {info.value.state, info.error, std::move(info.errorMessage)};
+    }
+
+    Result<uint32_t> WindowManagerLinux::GetWindowProcessId(NativeHandle handle, Deadline deadline)
+    {
+        Result<uint32_t> result;
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
+        {
+            result.errorMessage = GetLastError();
+            return result;
+        }
+
+        // _NET_WM_PID, and X-Resource only when the window does not set it
+        Xcb::ReplyWait wait{deadline};
+        result.value = GetWindowPidInternal(static_cast<Window>(handle), wait);
+        SetDeadlineError(result, wait);
+        return result;
+    }
+
+    bool WindowManagerLinux::IsWindowVisible(NativeHandle handle)
+    {
+        if (CheckConnection() != ErrorCode::Success || !IsValidWindow(handle))
+        {
+            return false;
+        }
+
+        Xcb::ReplyWait wait;
+        auto cookie = xcb_get_window_attributes(m_xcb, static_cast<xcb_window_t>(handle));
+        Xcb::Reply<xcb_get_window_attributes_reply_t> attrs(
+            static_cast<xcb_get_window_attributes_reply_t *>(Xcb::WaitForReply(m_xcb, cookie.sequence, wait)));
+        return attrs && attrs->map_state == XCB_MAP_STATE_VIEWABLE;
+    }
+
+    bool WindowManagerLinux::IsValidWindow(NativeHandle handle)
+    {
+        if (CheckConnection() != ErrorCode::Success)
+        {
+            return false;
+        }
+
+        // A followed window is alive until its DestroyNotify arrives
+        ProcessPendingEvents();
+        if (m_tracker.IsFollowed(static_cast<xcb_window_t>(handle)))
+        {
+            return true;
+        }
+
+        // A checked request reports BadWindow in its reply rather than through
+        // Xlib's process-wide error handler, which other threads may be using
+        Xcb::ReplyWait wait;
+        auto cookie = xcb_get_window_attributes(m_xcb, static_cast<xcb_window_t>(handle));
+        Xcb::Reply<xcb_get_window_attributes_reply_t> attrs(
+            static_cast<xcb_get_window_attributes_reply_t *>(Xcb::WaitForReply(m_xcb, cookie.sequence, wait)));
+        return attrs != nullptr;
+    }
+
+    xcb_atom_t WindowManagerLinux::LookupAtom(const std::string &name, bool create)
+    {
+        auto it = m_atomsByName.find(name);
+        if (it != m_atomsByName.end())
+        {
+            return it->second;
+        }
+
+        // An atom nobody has interned cannot name a property yet, so reads do
+        // not create it; the miss is not remembered since a client may create it later
+        Xcb::ReplyWait wait;
+        auto cookie = xcb_intern_atom(m_xcb, create ? 0 : 1, static_cast<uint16_t>(name.size()), name.c_str());
+        Xcb::Reply<xcb_intern_atom_reply_t> reply(
+            static_cast<xcb_intern_atom_reply_t *>(Xcb::WaitForReply(m_xcb, cookie.sequence, wait)));
+        if (!reply || reply->atom == XCB_NONE)
+        {
+            return XCB_NONE;
+        }
+
+        m_atomsByName[name] = reply->atom;
+        m_atomNames[reply->atom] = name;
+        return reply->atom;
+    }
+
+    void WindowManagerLinux::ResolveAtomNames(const std::vector<xcb_atom_t> &atoms)
+    {
+        // Every unknown name is requested before the first reply is awaited
+        std::vector<std::pair<xcb_atom_t, unsigned int>> pending;
+        for (xcb_atom_t atom : atoms)
+        {
+            if (atom == XCB_NONE || m_atomNames.count(atom))
+            {
+                continue;
+            }
+            bool requested = std::any_of(pending.begin(), pending.end(),
+                                         [atom](const std::pair<xcb_atom_t, unsigned int> &p)
+                                         { return p.first == atom; });
+            if (!requested)
+            {
+                pending.emplace_back(atom, xcb_get_atom_name(m_xcb, atom).sequence);
+            }
         }
 
-        auto windows = GetClientList();
-        for (Window w : windows)
+        Xcb::ReplyWait wait;
+        for (const auto &[atom, sequence] : pending)
         {
-            auto info = GetWindowInfo(w);
-            if (info.ok())
+            Xcb::Reply<xcb_get_atom_name_reply_t> reply(
+                static_cast<xcb_get_atom_name_reply_t *>(Xcb::WaitForReply(m_xcb, sequence, wait)));
+            if (!reply)
             {
-                if (!callback(info.value))
-                {
-                    break;
-                }
+                continue;
             }
+
+            std::string name(xcb_get_atom_name_name(reply.get()), xcb_get_atom_name_name_length(reply.get()));
+            m_atomsByName[name] = atom;
+            m_atomNames[atom] = std::move(name);
         }
     }
 
-    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByTitle(const std::string &titlePattern,
-                                                                   bool caseSensitive)
+    std::vector<Result<WindowProperty>> WindowManagerLinux::GetWindowProperties(
+        const std::vector<NativeHandle> &handles, const std::string &atomName)
     {
-        std::vector<WindowInfo> result;
-
-        if (!m_initialized)
+        std::vector<Result<WindowProperty>> results(handles.size());
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return result;
+            for (auto &result : results)
+            {
+                result.error = status;
+                result.errorMessage = GetLastError();
+            }
+            return results;
         }
 
-        auto windows = GetClientList();
-        for (Window w : windows)
-        {
-            std::string title = GetWindowTitleInternal(w);
+        xcb_atom_t atom = LookupAtom(atomName, false);
+        const uint32_t length = LengthFor(m_propertyLimits.maxPropertyBytes);
+        const xcb_atom_t anyType = XCB_GET_PROPERTY_TYPE_ANY;
 
-            bool matches = false;
-            if (caseSensitive)
+        // Cached values need no request; the rest share one round trip. Without
+        // the atom no window can have the property, but handles are still checked
+        ProcessPendingEvents();
+        std::vector<Xcb::PropertyValue> values(handles.size());
+        std::vector<unsigned int> sequences(handles.size(), 0);
+        std::vector<char> cacheable(handles.size(), 0);
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            xcb_window_t id = static_cast<xcb_window_t>(handles[i]);
+            if (atom == XCB_NONE)
             {
-                matches = title.find(titlePattern) != std::string::npos;
+                sequences[i] = xcb_get_window_attributes(m_xcb, id).sequence;
             }
-            else
+            else if (!m_properties.Lookup(id, atom, anyType, length, values[i]))
             {
-                matches = ToLowerCompare(title, titlePattern);
+                cacheable[i] = FollowWindow(id);
+                sequences[i] = xcb_get_property(m_xcb, 0, id, atom, anyType, 0, length).sequence;
             }
+        }
 
-            if (matches)
+        Xcb::ReplyWait wait;
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            if (sequences[i] != 0)
             {
-                auto info = GetWindowInfo(w);
-                if (info.ok())
+                Xcb::Reply<void> reply(Xcb::WaitForReply(m_xcb, sequences[i], wait));
+                if (!reply)
+                {
+                    results[i].error = ErrorCode::InvalidHandle;
+                    results[i].errorMessage = "Invalid window handle"_msg;
+                    continue;
+                }
+                if (atom != XCB_NONE)
                 {
-                    result.push_back(info.value);
+                    auto *property = static_cast<const xcb_get_property_reply_t *>(reply.get());
+                    values[i] = Xcb::PropertyValue::FromReply(property);
+                    if (cacheable[i])
+                    {
+                        m_properties.Store(static_cast<xcb_window_t>(handles[i]), atom, anyType, length, property);
+                    }
                 }
             }
-        }
-
-        return result;
-    }
 
-    std::vector<WindowInfo> WindowManagerLinux::FindWindowsByProcess(const std::string &processName)
-    {
-        std::vector<WindowInfo> result;
+            WindowProperty &out = results[i].value;
+            out.format = values[i].format;
+            if (out.format != 0)
+            {
+                out.data = std::move(values[i].data);
+                out.truncated = values[i].bytesAfter > 0;
+            }
+        }
 
-        if (!m_initialized)
+        std::vector<xcb_atom_t> types;
+        types.reserve(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
         {
-            return result;
+            if (results[i].value.format != 0)
+            {
+                types.push_back(values[i].type);
+            }
         }
-
-        auto windows = GetClientList();
-        for (Window w : windows)
+        ResolveAtomNames(types);
+        for (size_t i = 0; i < values.size(); ++i)
         {
-            uint32_t pid = GetWindowPidInternal(w);
-            std::string procName = GetProcessNameFromPid(pid);
-
-            if (ToLowerCompare(procName, processName))
+            if (results[i].value.format != 0)
             {
-                auto info = GetWindowInfo(w);
-                if (info.ok())
+                auto name = m_atomNames.find(values[i].type);
+                if (name != m_atomNames.end())
                 {
-                    result.push_back(info.value);
+                    results[i].value.type = name->second;
                 }
             }
         }
-
-        return result;
+        xcb_flush(m_xcb);
+        return results;
     }
 
-    Result<WindowInfo> WindowManagerLinux::GetWindowInfo(NativeHandle handle)
+    int WindowManagerLinux::WatchProperty(NativeHandle handle, const std::string &atomName,
+                                          PropertyChangeCallback callback)
     {
-        Result<WindowInfo> result;
-        Window window = static_cast<Window>(handle);
-
-        if (!m_initialized)
+        if (CheckConnection() != ErrorCode::Success)
         {
-            result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
-            return result;
+            return 0;
         }
-
-        if (!IsValidWindow(handle))
+        if (!callback || !IsValidWindow(handle))
         {
-            result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
-            return result;
+            SetLastError("Invalid window handle"_msg);
+            return 0;
         }
 
-        result.value.handle = handle;
-        result.value.title = GetWindowTitleInternal(window);
-        result.value.className = GetWindowClassInternal(window);
-        result.value.processId = GetWindowPidInternal(window);
-        result.value.processName = GetProcessNameFromPid(result.value.processId);
-
-        // Get geometry
-        XWindowAttributes attrs;
-        if (XGetWindowAttributes(m_display, window, &attrs))
+        xcb_atom_t atom = LookupAtom(atomName, true);
+        if (atom == XCB_NONE)
         {
-            // Get the absolute position
-            Window child;
-            int absX, absY;
-            XTranslateCoordinates(m_display, window, m_rootWindow, 0, 0, &absX, &absY, &child);
-
-            result.value.rect.x = absX;
-            result.value.rect.y = absY;
-            result.value.rect.width = attrs.width;
-            result.value.rect.height = attrs.height;
-            result.value.isVisible = (attrs.map_state == IsViewable);
+            SetLastError("Could not intern atom " + atomName);
+            return 0;
         }
 
-        // Get state
-        result.value.state = WindowState::Normal;
-        if (HasWmState(window, m_atomNetWmStateHidden))
-        {
-            result.value.state = result.value.state | WindowState::Minimized;
-        }
-        if (HasWmState(window, m_atomNetWmStateMaximizedVert) &&
-            HasWmState(window, m_atomNetWmStateMaximizedHorz))
+        xcb_window_t window = static_cast<xcb_window_t>(handle);
+        if (!FollowWindow(window))
         {
-            result.value.state = result.value.state | WindowState::Maximized;
+            // Adopted connection: add PropertyChange to whatever the host selects
+            // on the window; the host forwards the events through ProcessEvent
+            Xcb::ReplyWait wait;
+            auto cookie = xcb_get_window_attributes(m_xcb, window);
+            Xcb::Reply<xcb_get_window_attributes_reply_t> attrs(
+                static_cast<xcb_get_window_attributes_reply_t *>(Xcb::WaitForReply(m_xcb, cookie.sequence, wait)));
+            if (!attrs)
+            {
+                SetLastError("Invalid window handle"_msg);
+                return 0;
+            }
+            if (!(attrs->your_event_mask & XCB_EVENT_MASK_PROPERTY_CHANGE))
+            {
+                const uint32_t events = attrs->your_event_mask | XCB_EVENT_MASK_PROPERTY_CHANGE;
+                xcb_change_window_attributes(m_xcb, window, XCB_CW_EVENT_MASK, &events);
+            }
         }
-        if (HasWmState(window, m_atomNetWmStateFullscreen))
+        xcb_flush(m_xcb);
+
+        PropertyWatch watch;
+        watch.id = m_nextWatchId++;
+        watch.window = window;
+        watch.atom = atom;
+        watch.atomName = atomName;
+        watch.callback = std::move(callback);
+        m_watches.push_back(std::move(watch));
+        return m_watches.back().id;
+    }
+
+    bool WindowManagerLinux::UnwatchProperty(int watchId)
+    {
+        auto it = std::find_if(m_watches.begin(), m_watches.end(), [&](const PropertyWatch &w)
+                               { return w.id == watchId; });
+        if (it == m_watches.end())
         {
-            result.value.state = result.value.state | WindowState::Fullscreen;
+            return false;
         }
-        if (HasWmState(window, m_atomNetWmStateAbove))
+        m_watches.erase(it);
+        return true;
+    }
+
+    WindowId WindowManagerLinux::GetWindowId(NativeHandle handle)
+    {
+        if (!IsValidWindow(handle))
         {
-            result.value.state = result.value.state | WindowState::AlwaysOnTop;
+            return WindowId{handle, 0};
         }
 
-        // Check if focused
-        Window focusedWindow = static_cast<Window>(GetFocusedWindow());
-        if (focusedWindow == window)
+        // The process is only the window's identity when DestroyNotify is not tracked
+        WindowInfo info;
+        info.handle = handle;
+        if (!m_tracker.IsTracking())
         {
-            result.value.state = result.value.state | WindowState::Focused;
+            info.processId = GetWindowPidInternal(static_cast<Window>(handle));
         }
-
-        result.error = ErrorCode::Success;
-        return result;
+        TrackWindow(info);
+        xcb_flush(m_xcb);
+        return WindowId{handle, info.generation};
     }
 
-    Result<std::string> WindowManagerLinux::GetWindowTitle(NativeHandle handle)
+    bool WindowManagerLinux::IsCurrentWindow(const WindowId &id)
     {
-        Result<std::string> result;
-
-        if (!m_initialized)
+        if (CheckConnection() != ErrorCode::Success)
         {
-            result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
-            return result;
+            return false;
         }
 
-        if (!IsValidWindow(handle))
+        // Destroy notifications already received decide most ids without a round trip
+        ProcessPendingEvents();
+        xcb_window_t window = static_cast<xcb_window_t>(id.handle);
+        switch (m_tracker.Check(window, id.generation))
         {
-            result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
-            return result;
+        case WindowTracker::IdStatus::Current:
+            return true;
+        case WindowTracker::IdStatus::Stale:
+            return false;
+        case WindowTracker::IdStatus::Unknown:
+            break;
         }
 
-        result.value = GetWindowTitleInternal(static_cast<Window>(handle));
-        result.error = ErrorCode::Success;
-        return result;
+        if (!IsValidWindow(id.handle))
+        {
+            return false;
+        }
+        uint32_t processId = id.generation != 0 ? m_tracker.ProcessOf(window) : 0;
+        return processId == 0 || GetWindowPidInternal(static_cast<Window>(id.handle)) == processId;
     }
 
-    Result<Rect> WindowManagerLinux::GetWindowRect(NativeHandle handle)
+    ErrorCode WindowManagerLinux::CheckWindowId(const WindowId &id)
     {
-        Result<Rect> result;
-        Window window = static_cast<Window>(handle);
-
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
-            return result;
+            return status;
         }
-
-        if (!IsValidWindow(handle))
+        if (!IsCurrentWindow(id))
         {
-            result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
-            return result;
+            SetLastError("Window id is stale"_msg);
+            return ErrorCode::WindowNotFound;
         }
+        return ErrorCode::Success;
+    }
 
-        XWindowAttributes attrs;
-        if (XGetWindowAttributes(m_display, window, &attrs))
-        {
-            Window child;
-            int absX, absY;
-            XTranslateCoordinates(m_display, window, m_rootWindow, 0, 0, &absX, &absY, &child);
-
-            result.value.x = absX;
-            result.value.y = absY;
-            result.value.width = attrs.width;
-            result.value.height = attrs.height;
-            result.error = ErrorCode::Success;
-        }
-        else
+    NativeHandle WindowManagerLinux::GetFocusedWindow()
+    {
+        if (CheckConnection() != ErrorCode::Success)
         {
-            result.error = ErrorCode::OperationFailed;
-            result.errorMessage = "Failed to get window attributes";
+            return 0;
         }
 
-        return result;
+        Xcb::ReplyWait wait;
+        return static_cast<NativeHandle>(Xcb::GetActiveWindow(m_xcb, static_cast<xcb_window_t>(m_rootWindow),
+                                                              static_cast<xcb_atom_t>(m_atomNetActiveWindow), wait));
     }
 
-    Result<WindowState> WindowManagerLinux::GetWindowState(NativeHandle handle)
+    Result<WindowInfo> WindowManagerLinux::GetFocusedWindowInfo()
     {
-        Result<WindowState> result;
-        Window window = static_cast<Window>(handle);
-
-        if (!m_initialized)
+        NativeHandle focused = GetFocusedWindow();
+        if (focused == 0)
         {
-            result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            Result<WindowInfo> result;
+            result.error = ErrorCode::WindowNotFound;
+            result.errorMessage = "No focused window found"_msg;
             return result;
         }
+        return GetWindowInfo(focused);
+    }
 
-        if (!IsValidWindow(handle))
+    Result<WindowInfo> WindowManagerLinux::GetFocusedWindowInfo(Deadline deadline)
+    {
+        Result<WindowInfo> result;
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
         {
-            result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = GetLastError();
             return result;
         }
 
-        result.value = WindowState::Normal;
-
-        if (HasWmState(window, m_atomNetWmStateHidden))
-        {
-            result.value = result.value | WindowState::Minimized;
-        }
-        if (HasWmState(window, m_atomNetWmStateMaximizedVert) &&
-            HasWmState(window, m_atomNetWmStateMaximizedHorz))
+        Xcb::ReplyWait wait{deadline};
+        xcb_window_t focused = Xcb::GetActiveWindow(m_xcb, static_cast<xcb_window_t>(m_rootWindow),
+                                                    static_cast<xcb_atom_t>(m_atomNetActiveWindow), wait);
+        if (wait.timedOut)
         {
-            result.value = result.value | WindowState::Maximized;
+            result.error = ErrorCode::Timeout;
+            result.errorMessage = "Timed out waiting for the X server"_msg;
+            return result;
         }
-        if (HasWmState(window, m_atomNetWmStateFullscreen))
+        if (focused == XCB_NONE)
         {
-            result.value = result.value | WindowState::Fullscreen;
+            result.error = ErrorCode::WindowNotFound;
+            result.errorMessage = "No focused window found"_msg;
+            return result;
         }
-        if (HasWmState(window, m_atomNetWmStateAbove))
+        return GetWindowInfo(static_cast<NativeHandle>(focused), deadline);
+    }
+
+    std::vector<WindowResourceUsage> WindowManagerLinux::GetWindowResourceUsage()
+    {
+        auto windows = GetAllWindows();
+
+        std::vector<uint32_t> pids;
+        pids.reserve(windows.size());
+        for (const auto &info : windows)
         {
-            result.value = result.value | WindowState::AlwaysOnTop;
+            pids.push_back(info.processId);
         }
+        m_sampler.SamplePass(pids, m_procReader);
 
-        Window focusedWindow = static_cast<Window>(GetFocusedWindow());
-        if (focusedWindow == window)
+        std::vector<WindowResourceUsage> result;
+        result.reserve(windows.size());
+        for (auto &info : windows)
         {
-            result.value = result.value | WindowState::Focused;
+            WindowResourceUsage entry;
+            if (const ResourceUsage *usage = m_sampler.Latest(info.processId))
+            {
+                entry.usage = *usage;
+            }
+            entry.window = std::move(info);
+            result.push_back(std::move(entry));
         }
-
-        result.error = ErrorCode::Success;
         return result;
     }
 
-    Result<uint32_t> WindowManagerLinux::GetWindowProcessId(NativeHandle handle)
+    Result<ResourceUsage> WindowManagerLinux::GetWindowResourceUsage(NativeHandle handle)
     {
-        Result<uint32_t> result;
+        Result<ResourceUsage> result;
 
-        if (!m_initialized)
+        result.error = CheckConnection();
+        if (result.error != ErrorCode::Success)
         {
-            result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = GetLastError();
             return result;
         }
 
         if (!IsValidWindow(handle))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
-        result.value = GetWindowPidInternal(static_cast<Window>(handle));
-        result.error = ErrorCode::Success;
-        return result;
-    }
-
-    bool WindowManagerLinux::IsWindowVisible(NativeHandle handle)
-    {
-        if (!m_initialized || !IsValidWindow(handle))
+        uint32_t pid = GetWindowPidInternal(static_cast<Window>(handle));
+        if (pid == 0 || !m_sampler.Sample(pid))
         {
-            return false;
+            result.error = ErrorCode::OperationFailed;
+            result.errorMessage = "Owning process is unknown or has exited"_msg;
+            return result;
         }
 
-        XWindowAttributes attrs;
-        if (XGetWindowAttributes(m_display, static_cast<Window>(handle), &attrs))
-        {
-            return attrs.map_state == IsViewable;
-        }
-        return false;
+        result.value = *m_sampler.Latest(pid);
+        result.error = ErrorCode::Success;
+        return result;
     }
 
-    bool WindowManagerLinux::IsValidWindow(NativeHandle handle)
+    std::vector<ResourceUsage> WindowManagerLinux::GetProcessUsageHistory(uint32_t processId)
     {
-        if (!m_initialized)
-        {
-            return false;
-        }
-
-        Window window = static_cast<Window>(handle);
-        XWindowAttributes attrs;
-
-        // Set error handler to catch BadWindow errors
-        XErrorHandler oldHandler = XSetErrorHandler([](Display *, XErrorEvent *) -> int
-                                                    { return 0; });
-
-        bool valid = XGetWindowAttributes(m_display, window, &attrs) != 0;
-
-        XSetErrorHandler(oldHandler);
-        return valid;
+        return m_sampler.History(processId);
     }
 
-    NativeHandle WindowManagerLinux::GetFocusedWindow()
+    ErrorCode WindowManagerLinux::CloseWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return 0;
+            return status;
         }
 
-        Atom actualType;
-        int actualFormat;
-        unsigned long numItems, bytesAfter;
-        unsigned char *data = nullptr;
-
-        int status = XGetWindowProperty(m_display, m_rootWindow, m_atomNetActiveWindow,
-                                        0, 1, False, XA_WINDOW,
-                                        &actualType, &actualFormat, &numItems,
-                                        &bytesAfter, &data);
-
-        Window activeWindow = 0;
-        if (status == X11Success && data && numItems > 0)
+        if (!IsValidWindow(handle))
         {
-            activeWindow = *reinterpret_cast<Window *>(data);
+            return ErrorCode::InvalidHandle;
         }
 
-        if (data)
-            XFree(data);
-
-        return activeWindow;
-    }
-
-    Result<WindowInfo> WindowManagerLinux::GetFocusedWindowInfo()
-    {
-        NativeHandle focused = GetFocusedWindow();
-        if (focused == 0)
-        {
-            Result<WindowInfo> result;
-            result.error = ErrorCode::WindowNotFound;
-            result.errorMessage = "No focused window found";
-            return result;
-        }
-        return GetWindowInfo(focused);
+        Window window = static_cast<Window>(handle);
+        SendClientMessage(window, m_atomNetCloseWindow, CurrentTime, 1);
+        return ErrorCode::Success;
     }
 
-    ErrorCode WindowManagerLinux::CloseWindow(NativeHandle handle)
+    ErrorCode WindowManagerLinux::ForceCloseWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -687,33 +2332,39 @@ namespace CrossWindow
         }
 
         Window window = static_cast<Window>(handle);
-        SendClientMessage(window, m_atomNetCloseWindow, CurrentTime, 1);
+        XKillClient(m_display, window);
+        XFlush(m_display);
         return ErrorCode::Success;
     }
 
-    ErrorCode WindowManagerLinux::ForceCloseWindow(NativeHandle handle)
+    ErrorCode WindowManagerLinux::CloseProcessTreeWindows(uint32_t rootProcessId)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
-        if (!IsValidWindow(handle))
+        auto windows = WindowsOfProcessTree(rootProcessId);
+        if (rootProcessId == 0 || windows.empty())
         {
-            return ErrorCode::InvalidHandle;
+            return ErrorCode::WindowNotFound;
         }
 
-        Window window = static_cast<Window>(handle);
-        XKillClient(m_display, window);
+        // Windows come straight from the client list, so no per-window validity
+        // round trip; the requests go out with a single flush
+        for (const auto &info : windows)
+        {
+            QueueClientMessage(static_cast<Window>(info.handle), m_atomNetCloseWindow, CurrentTime, 1);
+        }
         XFlush(m_display);
         return ErrorCode::Success;
     }
 
     ErrorCode WindowManagerLinux::MinimizeWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -729,9 +2380,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::MaximizeWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -751,9 +2402,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::RestoreWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -777,9 +2428,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::ShowWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -795,9 +2446,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::HideWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -813,9 +2464,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::FocusWindow(NativeHandle handle)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -833,9 +2484,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::SetAlwaysOnTop(NativeHandle handle, bool topmost)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -850,9 +2501,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::SetWindowRect(NativeHandle handle, const Rect &rect)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -868,9 +2519,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::MoveWindow(NativeHandle handle, int x, int y)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -886,9 +2537,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::ResizeWindow(NativeHandle handle, int width, int height)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -904,9 +2555,9 @@ namespace CrossWindow
 
     ErrorCode WindowManagerLinux::SetWindowTitle(NativeHandle handle, const std::string &title)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -925,14 +2576,18 @@ namespace CrossWindow
                         title.length());
 
         XFlush(m_display);
+
+        // The notifications may not be back before the title is read again
+        m_properties.Invalidate(static_cast<xcb_window_t>(window), static_cast<xcb_atom_t>(m_atomWmName));
+        m_properties.Invalidate(static_cast<xcb_window_t>(window), static_cast<xcb_atom_t>(m_atomNetWmName));
         return ErrorCode::Success;
     }
 
     ErrorCode WindowManagerLinux::SetWindowOpacity(NativeHandle handle, float opacity)
     {
-        if (!m_initialized)
+        if (ErrorCode status = CheckConnection(); status != ErrorCode::Success)
         {
-            return ErrorCode::NotInitialized;
+            return status;
         }
 
         if (!IsValidWindow(handle))
@@ -956,14 +2611,30 @@ namespace CrossWindow
         return ErrorCode::Success;
     }
 
-    std::string WindowManagerLinux::GetLastError() const
+    ErrorMessage WindowManagerLinux::GetLastError() const
     {
         return m_lastError;
     }
 
-    void WindowManagerLinux::SetLastError(const std::string &error)
+    void WindowManagerLinux::SetLastError(ErrorMessage error)
+    {
+        m_lastError = std::move(error);
+    }
+
+    void WindowManagerLinux::SetPropertyLimits(const PropertyLimits &limits)
+    {
+        m_propertyLimits = limits;
+        m_fetch.limits = limits;
+    }
+
+    EnumerationStrategy WindowManagerLinux::GetLastEnumerationStrategy() const
+    {
+        return m_lastStrategy;
+    }
+
+    bool WindowManagerLinux::WasLastEnumerationPartial() const
     {
-        m_lastError = error;
+        return m_lastPartial;
     }
 
 } // namespace CrossWindow
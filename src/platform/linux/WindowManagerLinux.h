@@ -9,26 +9,54 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
+#include <xcb/xcb.h>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "XcbPipeline.h"
+#include "ClientPidCache.h"
+#include "RandrMonitors.h"
+#include "WindowTracker.h"
+#include "PropertyCache.h"
+#include "CgroupCache.h"
+#include "ProcessSampler.h"
+#include "ProcessTree.h"
+#include "ProcBatchReader.h"
 
 namespace CrossWindow
 {
 
-    class WindowManagerLinux : public WindowManagerImplBase
+    class WindowManagerLinux final : public WindowManagerImplBase
     {
     public:
         WindowManagerLinux();
         ~WindowManagerLinux() override;
 
         bool Initialize() override;
+        bool Initialize(const std::string &displayName) override;
+        bool Initialize(const ExternalConnection &connection) override;
+        bool ProcessEvent(const void *event) override;
+        bool ProcessXEvent(const void *event) override;
         bool IsInitialized() const override;
+        bool IsConnected() const override;
         void Shutdown() override;
 
         // Enumeration
         std::vector<WindowInfo> GetAllWindows() override;
-        void EnumerateWindows(const EnumWindowsCallback &callback) override;
+        std::vector<WindowInfo> GetAllWindows(const EnumerationOptions &options) override;
+        void EnumerateWindows(WindowCallbackRef callback) override;
+        void EnumerateWindows(WindowCallbackRef callback, const EnumerationOptions &options) override;
+        void EnumerateWindowBatches(WindowBatchCallbackRef callback, const EnumerationOptions &options) override;
         std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern,
                                                    bool caseSensitive) override;
         std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName) override;
+        std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern, bool caseSensitive,
+                                                   Deadline deadline) override;
+        std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName, Deadline deadline) override;
+        std::vector<WindowInfo> FindWindowsByCgroup(const std::string &pattern) override;
+        std::vector<ApplicationGroup> GroupWindowsByApplication() override;
+        std::vector<WindowInfo> FindWindowsByProcessTree(uint32_t rootProcessId) override;
 
         // Information
         Result<WindowInfo> GetWindowInfo(NativeHandle handle) override;
@@ -36,16 +64,48 @@ namespace CrossWindow
         Result<Rect> GetWindowRect(NativeHandle handle) override;
         Result<WindowState> GetWindowState(NativeHandle handle) override;
         Result<uint32_t> GetWindowProcessId(NativeHandle handle) override;
+        Result<WindowInfo> GetWindowInfo(NativeHandle handle, Deadline deadline) override;
+        Result<std::string> GetWindowTitle(NativeHandle handle, Deadline deadline) override;
+        Result<Rect> GetWindowRect(NativeHandle handle, Deadline deadline) override;
+        Result<WindowState> GetWindowState(NativeHandle handle, Deadline deadline) override;
+        Result<uint32_t> GetWindowProcessId(NativeHandle handle, Deadline deadline) override;
         bool IsWindowVisible(NativeHandle handle) override;
         bool IsValidWindow(NativeHandle handle) override;
 
+        // Window properties
+        std::vector<Result<WindowProperty>> GetWindowProperties(const std::vector<NativeHandle> &handles,
+                                                                const std::string &atomName) override;
+        int WatchProperty(NativeHandle handle, const std::string &atomName, PropertyChangeCallback callback) override;
+        bool UnwatchProperty(int watchId) override;
+        bool PollEvents() override;
+
+        // Window ids
+        WindowId GetWindowId(NativeHandle handle) override;
+        bool IsCurrentWindow(const WindowId &id) override;
+        ErrorCode CheckWindowId(const WindowId &id) override;
+
         // Active window
         NativeHandle GetFocusedWindow() override;
         Result<WindowInfo> GetFocusedWindowInfo() override;
+        Result<WindowInfo> GetFocusedWindowInfo(Deadline deadline) override;
+
+        // Virtual desktops
+        int GetCurrentDesktop() override;
+        int GetDesktopCount() override;
+
+        // Monitors
+        std::vector<MonitorInfo> GetMonitors() override;
+        std::vector<WindowInfo> FindWindowsOnMonitor(int monitorIndex) override;
+
+        // Process resources
+        std::vector<WindowResourceUsage> GetWindowResourceUsage() override;
+        Result<ResourceUsage> GetWindowResourceUsage(NativeHandle handle) override;
+        std::vector<ResourceUsage> GetProcessUsageHistory(uint32_t processId) override;
 
         // Manipulation
         ErrorCode CloseWindow(NativeHandle handle) override;
         ErrorCode ForceCloseWindow(NativeHandle handle) override;
+        ErrorCode CloseProcessTreeWindows(uint32_t rootProcessId) override;
         ErrorCode MinimizeWindow(NativeHandle handle) override;
         ErrorCode MaximizeWindow(NativeHandle handle) override;
         ErrorCode RestoreWindow(NativeHandle handle) override;
@@ -59,13 +119,71 @@ namespace CrossWindow
         ErrorCode SetWindowTitle(NativeHandle handle, const std::string &title) override;
         ErrorCode SetWindowOpacity(NativeHandle handle, float opacity) override;
 
-        std::string GetLastError() const override;
-        void SetLastError(const std::string &error) override;
+        ErrorMessage GetLastError() const override;
+        void SetLastError(ErrorMessage error) override;
+
+        void SetPropertyLimits(const PropertyLimits &limits) override;
+        EnumerationStrategy GetLastEnumerationStrategy() const override;
+        bool WasLastEnumerationPartial() const override;
 
     private:
         Display *m_display = nullptr;
         Window m_rootWindow = 0;
 
+        // XCB connection used for pipelined requests (shared with Xlib when possible)
+        xcb_connection_t *m_xcb = nullptr;
+        bool m_ownsXcb = false;
+        bool m_ownsDisplay = false;
+        bool m_adopted = false; // The host owns the connection, reads its events and forwards them
+
+        // Connection loss: Xlib's exit is replaced by a flag, and the display
+        // requested at Initialize is reopened with backoff
+        std::string m_requestedDisplay;
+        bool m_connected = false;
+        bool m_ioErrorRaised = false;
+        std::chrono::steady_clock::time_point m_nextReconnect{};
+        std::chrono::milliseconds m_reconnectDelay{0};
+        std::string m_displayName;
+        Xcb::FetchContext m_fetch;
+        // Connections for FetchWindows shards, opened by the first call that needs them
+        // and kept until the main connection closes
+        std::vector<xcb_connection_t *> m_workerConnections;
+        Xcb::ClientPidCache m_pidCache; // X-Resource PIDs for clients without _NET_WM_PID
+        Xcb::RandrMonitors m_monitors;  // Kept current through RandR notifications
+        WindowTracker m_tracker;        // Generations of the windows handed out, retired on DestroyNotify
+        Xcb::PropertyCache m_properties; // Properties of followed windows, dropped on PropertyNotify
+        CgroupCache m_cgroups;
+        ProcessSampler m_sampler;
+        ProcessTree m_processTree;
+        Proc::BatchReader m_procReader; // Bulk /proc reads, through io_uring when available
+
+        // Atoms looked up by name for GetWindowProperty/WatchProperty, seeded with the fixed ones below
+        std::unordered_map<std::string, xcb_atom_t> m_atomsByName;
+        std::unordered_map<xcb_atom_t, std::string> m_atomNames;
+
+        // Property watches; changes are queued by event dispatch and delivered
+        // only from PollEvents/ProcessEvent, so callbacks never run mid-call
+        struct PropertyWatch
+        {
+            int id = 0;
+            xcb_window_t window = XCB_NONE;
+            xcb_atom_t atom = XCB_NONE;
+            std::string atomName;
+            PropertyChangeCallback callback;
+        };
+        std::vector<PropertyWatch> m_watches;
+        std::vector<std::pair<xcb_window_t, xcb_atom_t>> m_watchChanges;
+        int m_nextWatchId = 1;
+
+        // Root properties kept current through PropertyNotify on the root window
+        int m_currentDesktop = -1;
+        int m_desktopCount = 0;
+        bool m_desktopsValid = false;
+
+        EnumerationStrategy m_lastStrategy = EnumerationStrategy::ClientList;
+        bool m_lastPartial = false;
+        bool m_clientListTruncated = false; ///< Last _NET_CLIENT_LIST read hit maxClientListWindows
+
         // Atom cache
         Atom m_atomNetClientList = 0;
         Atom m_atomNetActiveWindow = 0;
@@ -84,17 +202,67 @@ namespace CrossWindow
         Atom m_atomWmName = 0;
         Atom m_atomWmClass = 0;
         Atom m_atomNetWmWindowOpacity = 0;
+        Atom m_atomNetWmDesktop = 0;
+        Atom m_atomNetCurrentDesktop = 0;
+        Atom m_atomNetNumberOfDesktops = 0;
+        Atom m_atomNetWmWindowType = 0;
+        Atom m_atomNetWmStateSkipTaskbar = 0;
+        Atom m_atomNetWmStateSkipPager = 0;
 
-        void InitializeAtoms();
-        std::string GetWindowTitleInternal(Window window);
+        bool OpenConnection(const std::string &displayName);
+        void InitializeConnection(bool selectEvents);
+        void CloseConnection();
+        ErrorCode CheckConnection();
+        bool Reconnect();
+        static void OnIOErrorExit(Display *display, void *userData);
+        std::vector<std::pair<const char *, Atom *>> AtomSlots();
+        std::vector<xcb_intern_atom_cookie_t> RequestAtoms();
+        void CollectAtoms(const std::vector<xcb_intern_atom_cookie_t> &cookies, Xcb::ReplyWait &wait);
+        void ProcessPendingEvents();
+        bool DispatchEvent(const xcb_generic_event_t *event);
+        bool HandlePropertyChange(xcb_window_t window, xcb_atom_t atom);
+        void HandleWindowDestroyed(xcb_window_t window);
+        void RefreshDesktops(Xcb::ReplyWait &wait);
+        const std::vector<MonitorInfo> &RefreshMonitors(Xcb::ReplyWait &wait);
+        bool ReadGeometry(xcb_window_t window, Rect &rect, bool *visible, Xcb::ReplyWait &wait);
+        void AssignMonitors(std::vector<WindowInfo> &windows, Xcb::ReplyWait &wait);
+        bool FollowWindow(xcb_window_t window);
+        void TrackWindow(WindowInfo &info);
+        bool ReadProperty(Window window, Atom property, Atom type, uint32_t length, Xcb::PropertyValue &out);
+        bool ReadProperty(Window window, Atom property, Atom type, uint32_t length, Xcb::PropertyValue &out,
+                          Xcb::ReplyWait &wait);
+        xcb_atom_t LookupAtom(const std::string &name, bool create);
+        void ResolveAtomNames(const std::vector<xcb_atom_t> &atoms);
+        bool DeliverWatches();
+        std::vector<Window> FilterWindows(const std::vector<Window> &windows, const EnumerationOptions &options,
+                                          Xcb::ReplyWait &wait);
+        std::string GetWindowTitleInternal(Window window, bool *truncated = nullptr);
+        std::string GetWindowTitleInternal(Window window, bool *truncated, Xcb::ReplyWait &wait);
         std::string GetWindowClassInternal(Window window);
         uint32_t GetWindowPidInternal(Window window);
+        uint32_t GetWindowPidInternal(Window window, Xcb::ReplyWait &wait);
+        uint32_t GetClientPid(Window window, Xcb::ReplyWait &wait);
         std::string GetProcessNameFromPid(uint32_t pid);
-        bool HasWmState(Window window, Atom state);
+        void FillProcessNames(std::vector<WindowInfo> &windows);
+        // The streaming enumeration behind EnumerateWindows; onWindow may move from its argument
+        void StreamWindows(FunctionRef<bool(WindowInfo &)> onWindow, const EnumerationOptions &options);
+        WindowState GetWindowStateInternal(Window window);
+        int GetWindowDesktopInternal(Window window);
+        void GetWindowTypeInternal(Window window, WindowInfo &info);
         void SendClientMessage(Window window, Atom messageType, long data0 = 0,
                                long data1 = 0, long data2 = 0, long data3 = 0, long data4 = 0);
+        void QueueClientMessage(Window window, Atom messageType, long data0 = 0,
+                                long data1 = 0, long data2 = 0, long data3 = 0, long data4 = 0);
+        std::vector<WindowInfo> WindowsOfProcessTree(uint32_t rootProcessId);
         void SetWmState(Window window, bool add, Atom state1, Atom state2 = 0);
-        std::vector<Window> GetClientList();
+        std::vector<Window> GetClientList(Xcb::ReplyWait &wait);
+        std::vector<WindowInfo> FetchWindows(const std::vector<Window> &windows, unsigned int workerCount,
+                                             Xcb::ReplyWait &wait);
+        void AttachCgroups(std::vector<WindowInfo> &windows);
+        // AttachCgroups for the streaming path, before any window has been fetched
+        void RefreshCgroups(const std::vector<xcb_window_t> &windows, Xcb::ClientPidCache::Pending &pidQuery,
+                            Xcb::ReplyWait &wait);
+        Result<WindowInfo> FetchWindowInfoUntil(NativeHandle handle, Deadline deadline);
         bool ToLowerCompare(const std::string &str, const std::string &pattern);
     };
 
@@ -0,0 +1,134 @@
+/**
+ * @file WindowTracker.cpp
+ * @brief Generation numbers that tell a window apart from a later one with the same id
+ */
+
+#include "WindowTracker.h"
+
+namespace CrossWindow
+{
+
+    uint64_t WindowTracker::Observe(xcb_window_t window, uint32_t processId, bool *isNew)
+    {
+        auto it = m_entries.find(window);
+        bool fresh = it == m_entries.end() || !it->second.alive;
+
+        // Without events, a different owner is the only sign that the id was reused
+        if (!fresh && !m_tracking && processId != 0 && it->second.processId != 0 &&
+            it->second.processId != processId)
+        {
+            fresh = true;
+        }
+
+        if (isNew)
+        {
+            *isNew = it == m_entries.end() || !it->second.alive;
+        }
+
+        if (!fresh)
+        {
+            if (it->second.processId == 0)
+            {
+                it->second.processId = processId;
+            }
+            return it->second.generation;
+        }
+
+        // Untracked entries are never retired by events; dropping one only loses
+        // the process check for ids of that window
+        if (!m_tracking && it == m_entries.end() && m_entries.size() >= kMaxUntracked)
+        {
+            m_entries.erase(m_entries.begin());
+        }
+
+        Entry &entry = m_entries[window];
+        entry.generation = m_nextGeneration++;
+        entry.processId = processId;
+        entry.alive = true;
+        return entry.generation;
+    }
+
+    bool WindowTracker::Follow(xcb_window_t window)
+    {
+        auto it = m_entries.find(window);
+        if (it != m_entries.end() && it->second.alive)
+        {
+            return false;
+        }
+
+        Entry &entry = m_entries[window];
+        entry = Entry{};
+        entry.generation = m_nextGeneration++;
+        return true;
+    }
+
+    bool WindowTracker::IsFollowed(xcb_window_t window) const
+    {
+        if (!m_tracking)
+        {
+            return false;
+        }
+        auto it = m_entries.find(window);
+        return it != m_entries.end() && it->second.alive;
+    }
+
+    void WindowTracker::Destroyed(xcb_window_t window)
+    {
+        auto it = m_entries.find(window);
+        if (it == m_entries.end() || !it->second.alive)
+        {
+            return;
+        }
+
+        it->second.alive = false;
+        m_tombstones.push_back(window);
+        while (m_tombstones.size() > kMaxTombstones)
+        {
+            auto old = m_entries.find(m_tombstones.front());
+            if (old != m_entries.end() && !old->second.alive)
+            {
+                m_entries.erase(old);
+            }
+            m_tombstones.pop_front();
+        }
+    }
+
+    WindowTracker::IdStatus WindowTracker::Check(xcb_window_t window, uint64_t generation) const
+    {
+        if (generation == 0)
+        {
+            return IdStatus::Unknown;
+        }
+        if (generation < m_epoch)
+        {
+            return IdStatus::Stale;
+        }
+
+        auto it = m_entries.find(window);
+        if (it == m_entries.end())
+        {
+            // Every generation of this epoch was recorded when issued; an entry
+            // only disappears after its window was destroyed
+            return m_tracking ? IdStatus::Stale : IdStatus::Unknown;
+        }
+        if (it->second.generation != generation || !it->second.alive)
+        {
+            return IdStatus::Stale;
+        }
+        return m_tracking ? IdStatus::Current : IdStatus::Unknown;
+    }
+
+    uint32_t WindowTracker::ProcessOf(xcb_window_t window) const
+    {
+        auto it = m_entries.find(window);
+        return it != m_entries.end() ? it->second.processId : 0;
+    }
+
+    void WindowTracker::Reset()
+    {
+        m_entries.clear();
+        m_tombstones.clear();
+        m_epoch = m_nextGeneration;
+    }
+
+} // namespace CrossWindow
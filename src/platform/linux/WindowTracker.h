@@ -0,0 +1,107 @@
+/**
+ * @file WindowTracker.h
+ * @brief Generation numbers that tell a window apart from a later one with the same id
+ *
+ * X reuses window ids once a window is destroyed. Every window handed out by
+ * the backend is given a generation the first time it is seen. When the
+ * backend owns the connection it also selects StructureNotify on the window,
+ * so DestroyNotify retires the generation and a stale WindowId is rejected
+ * without asking the server. On an adopted connection no events are selected.
+ * The process that owned the window when it was first seen then stands in
+ * for its identity, and checking it costs a round trip.
+ */
+
+#pragma once
+
+#include <xcb/xcb.h>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace CrossWindow
+{
+
+    class WindowTracker
+    {
+    public:
+        enum class IdStatus
+        {
+            Current, ///< The generation is the live window with that id
+            Stale,   ///< The window it named is gone
+            Unknown  ///< Only the server can tell (untracked, or generation 0)
+        };
+
+        /**
+         * @brief Choose between event tracking and the process heuristic
+         */
+        void SetTracking(bool tracking) { m_tracking = tracking; }
+
+        bool IsTracking() const { return m_tracking; }
+
+        /**
+         * @brief Generation of a window as seen now
+         * @param processId Owner of the window, used as its identity when untracked
+         * @param isNew Set when the window was not being followed before, so the
+         *        caller can select events on it
+         */
+        uint64_t Observe(xcb_window_t window, uint32_t processId, bool *isNew = nullptr);
+
+        /**
+         * @brief Start following a window before anything is read from it
+         *
+         * Gives the window its generation now, so events selected before the
+         * first read cover everything read afterwards.
+         *
+         * @return true if the window was not followed yet and events must be selected on it
+         */
+        bool Follow(xcb_window_t window);
+
+        /**
+         * @brief Whether DestroyNotify is selected on a window not yet reported destroyed
+         */
+        bool IsFollowed(xcb_window_t window) const;
+
+        /**
+         * @brief Retire the generation of a window after DestroyNotify
+         */
+        void Destroyed(xcb_window_t window);
+
+        /**
+         * @brief Decide whether an id is still current, without server traffic
+         */
+        IdStatus Check(xcb_window_t window, uint64_t generation) const;
+
+        /**
+         * @brief Process recorded for a window when it was first seen
+         * @return 0 if unknown
+         */
+        uint32_t ProcessOf(xcb_window_t window) const;
+
+        /**
+         * @brief Forget every window; ids issued before the call become stale
+         *
+         * Used when the connection is replaced, since a new server reuses ids freely.
+         */
+        void Reset();
+
+    private:
+        struct Entry
+        {
+            uint64_t generation = 0;
+            uint32_t processId = 0;
+            bool alive = true;
+        };
+
+        // Destroyed windows are remembered for a while so their ids stay
+        // recognisably stale; beyond that the absence of an entry says the same
+        static constexpr size_t kMaxTombstones = 1024;
+        static constexpr size_t kMaxUntracked = 8192;
+
+        bool m_tracking = false;
+        uint64_t m_nextGeneration = 1;
+        uint64_t m_epoch = 1; ///< Generations below this were issued on an earlier connection
+        std::unordered_map<xcb_window_t, Entry> m_entries;
+        std::deque<xcb_window_t> m_tombstones;
+    };
+
+} // namespace CrossWindow
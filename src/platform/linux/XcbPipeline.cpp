@@ -0,0 +1,665 @@
+/**
+ * @file XcbPipeline.cpp
+ * @brief Pipelined X11 requests used by the Linux backend
+ */
+
+#include "XcbPipeline.h"
+#include "PropertyCache.h"
+#include <xcb/xproto.h>
+#include <xcb/xcbext.h>
+#include <poll.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        const char *const kWindowTypeAtomNames[kWindowTypeCount] = {
+            "_NET_WM_WINDOW_TYPE_NORMAL",
+            "_NET_WM_WINDOW_TYPE_DESKTOP",
+            "_NET_WM_WINDOW_TYPE_DOCK",
+            "_NET_WM_WINDOW_TYPE_TOOLBAR",
+            "_NET_WM_WINDOW_TYPE_MENU",
+            "_NET_WM_WINDOW_TYPE_UTILITY",
+            "_NET_WM_WINDOW_TYPE_SPLASH",
+            "_NET_WM_WINDOW_TYPE_DIALOG",
+            "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+            "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+            "_NET_WM_WINDOW_TYPE_TOOLTIP",
+            "_NET_WM_WINDOW_TYPE_NOTIFICATION",
+            "_NET_WM_WINDOW_TYPE_COMBO",
+            "_NET_WM_WINDOW_TYPE_DND",
+        };
+
+        namespace
+        {
+            // Reparenting window managers nest clients at most a few frames deep.
+            // Anything deeper is application-internal and not worth searching.
+            constexpr int kMaxTreeWalkDepth = 4;
+
+            // GetProperty lengths are in 32-bit units; round byte caps up to whole units
+            uint32_t LengthFor(uint32_t bytes)
+            {
+                return bytes / 4 + (bytes % 4 != 0);
+            }
+
+            struct PendingNode
+            {
+                size_t branch;       // Index of the root child this node descends from
+                xcb_window_t window; // Window to inspect
+            };
+
+            // _NET_WM_DESKTOP value, or -1 when absent or 0xFFFFFFFF (on all desktops)
+            int DesktopOf(const xcb_get_property_reply_t *reply)
+            {
+                if (!reply || reply->format != 32 || xcb_get_property_value_length(reply) < 4)
+                {
+                    return -1;
+                }
+                uint32_t desktop = *static_cast<const uint32_t *>(xcb_get_property_value(reply));
+                return desktop == 0xFFFFFFFFu ? -1 : static_cast<int>(desktop);
+            }
+
+            const xcb_atom_t *AtomList(const xcb_get_property_reply_t *reply, size_t &count)
+            {
+                count = 0;
+                if (!reply || reply->format != 32)
+                {
+                    return nullptr;
+                }
+                count = static_cast<size_t>(xcb_get_property_value_length(reply)) / 4;
+                return static_cast<const xcb_atom_t *>(xcb_get_property_value(reply));
+            }
+
+            template <typename ReplyT, typename CookieT>
+            Reply<ReplyT> WaitReply(xcb_connection_t *conn, CookieT cookie, ReplyWait &wait)
+            {
+                return Reply<ReplyT>(static_cast<ReplyT *>(WaitForReply(conn, cookie.sequence, wait)));
+            }
+
+            // Text of a format-8 property up to the first NUL, like XFetchName
+            std::string PropertyText(const xcb_get_property_reply_t *reply)
+            {
+                if (!reply || reply->format != 8)
+                {
+                    return "";
+                }
+                const char *text = static_cast<const char *>(xcb_get_property_value(reply));
+                std::string value(text, static_cast<size_t>(xcb_get_property_value_length(reply)));
+                return value.substr(0, value.find('\0'));
+            }
+        } // namespace
+
+        void *WaitForReply(xcb_connection_t *conn, unsigned int sequence, ReplyWait &wait)
+        {
+            if (wait.timedOut)
+            {
+                xcb_discard_reply(conn, sequence);
+                return nullptr;
+            }
+
+            void *reply = nullptr;
+            xcb_generic_error_t *error = nullptr;
+            if (wait.deadline == NoDeadline)
+            {
+                reply = xcb_wait_for_reply(conn, sequence, &error);
+                wait.failed = wait.failed || error;
+                std::free(error);
+                return reply;
+            }
+
+            xcb_flush(conn);
+            while (!xcb_poll_for_reply(conn, sequence, &reply, &error))
+            {
+                auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+                    wait.deadline - std::chrono::steady_clock::now());
+                if (remaining.count() <= 0)
+                {
+                    wait.timedOut = true;
+                    xcb_discard_reply(conn, sequence);
+                    return nullptr;
+                }
+
+                pollfd pfd{xcb_get_file_descriptor(conn), POLLIN, 0};
+                poll(&pfd, 1, static_cast<int>(std::min<long long>(remaining.count(), INT32_MAX)));
+            }
+            wait.failed = wait.failed || error;
+            std::free(error);
+            return reply;
+        }
+
+        void TrimUtf8(std::string &text, size_t maxBytes)
+        {
+            if (text.size() > maxBytes)
+            {
+                text.resize(maxBytes);
+            }
+
+            // Drop a trailing multi-byte sequence that the cut left incomplete
+            size_t end = text.size();
+            size_t lead = end;
+            while (lead > 0 && (static_cast<unsigned char>(text[lead - 1]) & 0xC0) == 0x80)
+            {
+                --lead;
+            }
+            if (lead > 0)
+            {
+                unsigned char c = static_cast<unsigned char>(text[lead - 1]);
+                size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+                if (end - (lead - 1) < need)
+                {
+                    text.resize(lead - 1);
+                }
+            }
+        }
+
+        bool TitleCut(xcb_atom_t actualType, xcb_atom_t requestedType, uint32_t bytesAfter, size_t maxBytes,
+                      std::string &title)
+        {
+            // With another type (COMPOUND_TEXT for STRING, say) the server sends no
+            // data and reports the whole value as bytes_after; nothing was cut
+            bool cut = (actualType == requestedType && bytesAfter > 0) || title.size() > maxBytes;
+            if (!cut)
+            {
+                return false;
+            }
+
+            // Only UTF-8 can be left with a partial character; Latin-1 is one byte each
+            if (requestedType == XCB_ATOM_STRING)
+            {
+                title.resize(std::min(title.size(), maxBytes));
+            }
+            else
+            {
+                TrimUtf8(title, maxBytes);
+            }
+            return true;
+        }
+
+        bool ReadClientList(xcb_connection_t *conn, xcb_window_t root, xcb_atom_t netClientList,
+                            uint32_t maxWindows, ReplyWait &wait, std::vector<xcb_window_t> &out,
+                            bool *truncated)
+        {
+            if (truncated)
+            {
+                *truncated = false;
+            }
+
+            auto reply = WaitReply<xcb_get_property_reply_t>(
+                conn, xcb_get_property(conn, 0, root, netClientList, XCB_ATOM_WINDOW, 0, maxWindows), wait);
+            if (!reply || reply->type != XCB_ATOM_WINDOW)
+            {
+                // A timeout is not evidence that the window manager is missing
+                return wait.timedOut;
+            }
+
+            const xcb_window_t *list = static_cast<const xcb_window_t *>(xcb_get_property_value(reply.get()));
+            out.assign(list, list + xcb_get_property_value_length(reply.get()) / 4);
+            if (truncated)
+            {
+                *truncated = reply->bytes_after > 0;
+            }
+            return true;
+        }
+
+        std::vector<xcb_window_t> WalkClientTree(xcb_connection_t *conn, xcb_window_t root,
+                                                 xcb_atom_t wmState, ReplyWait &wait,
+                                                 TreeWalkStats *stats)
+        {
+            TreeWalkStats localStats;
+            TreeWalkStats &s = stats ? *stats : localStats;
+            s = TreeWalkStats{};
+
+            std::vector<xcb_window_t> result;
+
+            auto rootTree = WaitReply<xcb_query_tree_reply_t>(conn, xcb_query_tree(conn, root), wait);
+            s.roundTrips++;
+            if (!rootTree)
+            {
+                return result;
+            }
+
+            const xcb_window_t *topLevels = xcb_query_tree_children(rootTree.get());
+            const size_t topCount = static_cast<size_t>(xcb_query_tree_children_length(rootTree.get()));
+
+            // Attributes of the root children are only needed when no WM_STATE is found,
+            // but requesting them with the first level costs no extra round trip.
+            std::vector<xcb_get_window_attributes_cookie_t> attrCookies(topCount);
+            std::vector<PendingNode> frontier(topCount);
+            for (size_t i = 0; i < topCount; ++i)
+            {
+                attrCookies[i] = xcb_get_window_attributes(conn, topLevels[i]);
+                frontier[i] = {i, topLevels[i]};
+            }
+
+            std::vector<std::vector<xcb_window_t>> clients(topCount);
+
+            for (int depth = 0; depth < kMaxTreeWalkDepth && !frontier.empty(); ++depth)
+            {
+                // Ask every node of this level for WM_STATE in a single batch
+                std::vector<xcb_get_property_cookie_t> stateCookies(frontier.size());
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    stateCookies[i] = xcb_get_property(conn, 0, frontier[i].window, wmState,
+                                                       XCB_GET_PROPERTY_TYPE_ANY, 0, 0);
+                }
+                s.roundTrips++;
+                s.nodesVisited += frontier.size();
+
+                std::vector<bool> alive(frontier.size(), false);
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto prop = WaitReply<xcb_get_property_reply_t>(conn, stateCookies[i], wait);
+
+                    alive[i] = prop != nullptr;
+                    if (prop && prop->type != XCB_NONE)
+                    {
+                        clients[frontier[i].branch].push_back(frontier[i].window);
+                    }
+                }
+
+                std::vector<PendingNode> unresolved;
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    if (alive[i] && clients[frontier[i].branch].empty())
+                    {
+                        unresolved.push_back(frontier[i]);
+                    }
+                }
+
+                if (unresolved.empty() || depth + 1 >= kMaxTreeWalkDepth)
+                {
+                    break;
+                }
+
+                // Descend one level for every node that has not found its client yet
+                std::vector<xcb_query_tree_cookie_t> treeCookies(unresolved.size());
+                for (size_t i = 0; i < unresolved.size(); ++i)
+                {
+                    treeCookies[i] = xcb_query_tree(conn, unresolved[i].window);
+                }
+                s.roundTrips++;
+
+                std::vector<PendingNode> next;
+                for (size_t i = 0; i < unresolved.size(); ++i)
+                {
+                    auto tree = WaitReply<xcb_query_tree_reply_t>(conn, treeCookies[i], wait);
+                    if (!tree)
+                    {
+                        continue;
+                    }
+
+                    const xcb_window_t *children = xcb_query_tree_children(tree.get());
+                    const int childCount = xcb_query_tree_children_length(tree.get());
+                    for (int c = 0; c < childCount; ++c)
+                    {
+                        next.push_back({unresolved[i].branch, children[c]});
+                    }
+                }
+                frontier = std::move(next);
+            }
+
+            for (size_t i = 0; i < topCount; ++i)
+            {
+                auto attrs = WaitReply<xcb_get_window_attributes_reply_t>(conn, attrCookies[i], wait);
+
+                if (!clients[i].empty())
+                {
+                    result.insert(result.end(), clients[i].begin(), clients[i].end());
+                }
+                else if (attrs && !attrs->override_redirect &&
+                         attrs->_class == XCB_WINDOW_CLASS_INPUT_OUTPUT &&
+                         attrs->map_state == XCB_MAP_STATE_VIEWABLE)
+                {
+                    // No window manager tagged anything below this window; treat it as the client
+                    result.push_back(topLevels[i]);
+                }
+            }
+
+            return result;
+        }
+
+        WindowType WindowTypeFromAtoms(const xcb_atom_t *list, size_t count, const InfoAtoms &atoms)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (size_t t = 0; t < kWindowTypeCount; ++t)
+                {
+                    if (list[i] != XCB_NONE && list[i] == atoms.windowTypes[t])
+                    {
+                        return static_cast<WindowType>(1u << t);
+                    }
+                }
+            }
+            return WindowType::Normal;
+        }
+
+        WindowCookies RequestWindowInfo(xcb_connection_t *conn, xcb_window_t window,
+                                        const FetchContext &ctx)
+        {
+            const InfoAtoms &atoms = ctx.atoms;
+            const uint32_t titleLength = LengthFor(ctx.limits.maxTitleBytes);
+
+            WindowCookies c;
+            c.window = window;
+            c.attributes = xcb_get_window_attributes(conn, window);
+            c.geometry = xcb_get_geometry(conn, window);
+            c.position = xcb_translate_coordinates(conn, window, ctx.root, 0, 0);
+            c.netWmName = xcb_get_property(conn, 0, window, atoms.netWmName, atoms.utf8String,
+                                           0, titleLength);
+            c.wmName = xcb_get_property(conn, 0, window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING,
+                                        0, titleLength);
+            c.wmClass = xcb_get_property(conn, 0, window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING,
+                                         0, LengthFor(ctx.limits.maxClassBytes));
+            c.pid = xcb_get_property(conn, 0, window, atoms.netWmPid, XCB_ATOM_CARDINAL, 0, 1);
+            c.state = xcb_get_property(conn, 0, window, atoms.netWmState, XCB_ATOM_ATOM,
+                                       0, ctx.limits.maxStateAtoms);
+            c.desktop = xcb_get_property(conn, 0, window, atoms.netWmDesktop, XCB_ATOM_CARDINAL, 0, 1);
+            c.windowType = xcb_get_property(conn, 0, window, atoms.netWmWindowType, XCB_ATOM_ATOM,
+                                            0, ctx.limits.maxStateAtoms);
+            return c;
+        }
+
+        bool CollectWindowInfo(xcb_connection_t *conn, const WindowCookies &c,
+                               const FetchContext &ctx, xcb_window_t focused, WindowInfo &out,
+                               ReplyWait &wait)
+        {
+            const InfoAtoms &atoms = ctx.atoms;
+
+            // Take every reply, even on failure, so none are left queued on the connection
+            auto attrs = WaitReply<xcb_get_window_attributes_reply_t>(conn, c.attributes, wait);
+            auto geometry = WaitReply<xcb_get_geometry_reply_t>(conn, c.geometry, wait);
+            auto position = WaitReply<xcb_translate_coordinates_reply_t>(conn, c.position, wait);
+            auto netWmName = WaitReply<xcb_get_property_reply_t>(conn, c.netWmName, wait);
+            auto wmName = WaitReply<xcb_get_property_reply_t>(conn, c.wmName, wait);
+            auto wmClass = WaitReply<xcb_get_property_reply_t>(conn, c.wmClass, wait);
+            auto pid = WaitReply<xcb_get_property_reply_t>(conn, c.pid, wait);
+            auto state = WaitReply<xcb_get_property_reply_t>(conn, c.state, wait);
+            auto desktop = WaitReply<xcb_get_property_reply_t>(conn, c.desktop, wait);
+            auto windowType = WaitReply<xcb_get_property_reply_t>(conn, c.windowType, wait);
+
+            if (!attrs || wait.timedOut)
+            {
+                return false;
+            }
+
+            if (ctx.cache)
+            {
+                // Same types and lengths as RequestWindowInfo, so single reads hit these entries
+                const uint32_t titleLength = LengthFor(ctx.limits.maxTitleBytes);
+                ctx.cache->Store(c.window, atoms.netWmName, atoms.utf8String, titleLength, netWmName.get());
+                ctx.cache->Store(c.window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, titleLength, wmName.get());
+                ctx.cache->Store(c.window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, LengthFor(ctx.limits.maxClassBytes),
+                                 wmClass.get());
+                ctx.cache->Store(c.window, atoms.netWmPid, XCB_ATOM_CARDINAL, 1, pid.get());
+                ctx.cache->Store(c.window, atoms.netWmState, XCB_ATOM_ATOM, ctx.limits.maxStateAtoms, state.get());
+                ctx.cache->Store(c.window, atoms.netWmDesktop, XCB_ATOM_CARDINAL, 1, desktop.get());
+                ctx.cache->Store(c.window, atoms.netWmWindowType, XCB_ATOM_ATOM, ctx.limits.maxStateAtoms,
+                                 windowType.get());
+            }
+
+            out = WindowInfo{};
+            out.handle = static_cast<NativeHandle>(c.window);
+
+            // Prefer _NET_WM_NAME (UTF-8), fall back to WM_NAME (Latin-1)
+            const xcb_get_property_reply_t *titleReply = wmName.get();
+            xcb_atom_t titleType = XCB_ATOM_STRING;
+            if (netWmName && xcb_get_property_value_length(netWmName.get()) > 0)
+            {
+                titleReply = netWmName.get();
+                titleType = atoms.utf8String;
+                out.title.assign(static_cast<const char *>(xcb_get_property_value(titleReply)),
+                                 static_cast<size_t>(xcb_get_property_value_length(titleReply)));
+            }
+            else
+            {
+                out.title = PropertyText(titleReply);
+            }
+            if (TitleCut(titleReply ? titleReply->type : XCB_NONE, titleType,
+                         titleReply ? titleReply->bytes_after : 0, ctx.limits.maxTitleBytes, out.title))
+            {
+                out.titleTruncated = true;
+            }
+
+            // WM_CLASS holds "res_name\0res_class\0"; the class is the second string
+            if (wmClass && wmClass->format == 8)
+            {
+                const char *data = static_cast<const char *>(xcb_get_property_value(wmClass.get()));
+                std::string value(data, static_cast<size_t>(xcb_get_property_value_length(wmClass.get())));
+                size_t split = value.find('\0');
+                if (split != std::string::npos)
+                {
+                    std::string resClass = value.substr(split + 1);
+                    out.className = resClass.substr(0, resClass.find('\0'));
+                    out.classNameId = StringPool::Intern(out.className);
+                }
+            }
+
+            if (pid && pid->format == 32 && xcb_get_property_value_length(pid.get()) >= 4)
+            {
+                out.processId = *static_cast<const uint32_t *>(xcb_get_property_value(pid.get()));
+            }
+
+            out.desktop = DesktopOf(desktop.get());
+            size_t typeCount = 0;
+            const xcb_atom_t *types = AtomList(windowType.get(), typeCount);
+            out.type = WindowTypeFromAtoms(types, typeCount, atoms);
+
+            if (geometry && position)
+            {
+                out.rect.x = position->dst_x;
+                out.rect.y = position->dst_y;
+                out.rect.width = geometry->width;
+                out.rect.height = geometry->height;
+            }
+            out.isVisible = attrs->map_state == XCB_MAP_STATE_VIEWABLE;
+
+            out.state = WindowState::Normal;
+            if (state && state->format == 32)
+            {
+                const xcb_atom_t *list = static_cast<const xcb_atom_t *>(xcb_get_property_value(state.get()));
+                const int count = xcb_get_property_value_length(state.get()) / 4;
+                bool maxVert = false;
+                bool maxHorz = false;
+                for (int i = 0; i < count; ++i)
+                {
+                    if (list[i] == atoms.netWmStateHidden)
+                        out.state = out.state | WindowState::Minimized;
+                    else if (list[i] == atoms.netWmStateMaximizedVert)
+                        maxVert = true;
+                    else if (list[i] == atoms.netWmStateMaximizedHorz)
+                        maxHorz = true;
+                    else if (list[i] == atoms.netWmStateFullscreen)
+                        out.state = out.state | WindowState::Fullscreen;
+                    else if (list[i] == atoms.netWmStateAbove)
+                        out.state = out.state | WindowState::AlwaysOnTop;
+                    else if (list[i] == atoms.netWmStateSkipTaskbar)
+                        out.skipTaskbar = true;
+                    else if (list[i] == atoms.netWmStateSkipPager)
+                        out.skipPager = true;
+                }
+                if (maxVert && maxHorz)
+                {
+                    out.state = out.state | WindowState::Maximized;
+                }
+            }
+
+            if (focused != XCB_NONE && focused == c.window)
+            {
+                out.state = out.state | WindowState::Focused;
+            }
+
+            return true;
+        }
+
+        void DiscardWindowInfo(xcb_connection_t *conn, const WindowCookies &c)
+        {
+            xcb_discard_reply(conn, c.attributes.sequence);
+            xcb_discard_reply(conn, c.geometry.sequence);
+            xcb_discard_reply(conn, c.position.sequence);
+            xcb_discard_reply(conn, c.netWmName.sequence);
+            xcb_discard_reply(conn, c.wmName.sequence);
+            xcb_discard_reply(conn, c.wmClass.sequence);
+            xcb_discard_reply(conn, c.pid.sequence);
+            xcb_discard_reply(conn, c.state.sequence);
+            xcb_discard_reply(conn, c.desktop.sequence);
+            xcb_discard_reply(conn, c.windowType.sequence);
+        }
+
+        xcb_window_t GetActiveWindow(xcb_connection_t *conn, xcb_window_t root, xcb_atom_t netActiveWindow,
+                                     ReplyWait &wait)
+        {
+            auto reply = WaitReply<xcb_get_property_reply_t>(
+                conn, xcb_get_property(conn, 0, root, netActiveWindow, XCB_ATOM_WINDOW, 0, 1), wait);
+            if (reply && reply->format == 32 && xcb_get_property_value_length(reply.get()) >= 4)
+            {
+                return *static_cast<const xcb_window_t *>(xcb_get_property_value(reply.get()));
+            }
+            return XCB_NONE;
+        }
+
+        uint32_t ReadCardinal(xcb_connection_t *conn, xcb_window_t window, xcb_atom_t property,
+                              uint32_t fallback, ReplyWait &wait)
+        {
+            auto reply = WaitReply<xcb_get_property_reply_t>(
+                conn, xcb_get_property(conn, 0, window, property, XCB_ATOM_CARDINAL, 0, 1), wait);
+            if (reply && reply->format == 32 && xcb_get_property_value_length(reply.get()) >= 4)
+            {
+                return *static_cast<const uint32_t *>(xcb_get_property_value(reply.get()));
+            }
+            return fallback;
+        }
+
+        std::vector<xcb_window_t> FilterWindows(xcb_connection_t *conn, const FetchContext &ctx,
+                                                const xcb_window_t *windows, size_t count,
+                                                const WindowFilter &filter, ReplyWait &wait)
+        {
+            // Only the properties the filter looks at are requested
+            struct FilterCookies
+            {
+                xcb_get_property_cookie_t desktop{};
+                xcb_get_property_cookie_t type{};
+                xcb_get_property_cookie_t state{};
+            };
+            std::vector<FilterCookies> cookies(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (filter.byDesktop)
+                    cookies[i].desktop = xcb_get_property(conn, 0, windows[i], ctx.atoms.netWmDesktop,
+                                                          XCB_ATOM_CARDINAL, 0, 1);
+                if (filter.ByType())
+                    cookies[i].type = xcb_get_property(conn, 0, windows[i], ctx.atoms.netWmWindowType,
+                                                       XCB_ATOM_ATOM, 0, ctx.limits.maxStateAtoms);
+                if (filter.ByState())
+                    cookies[i].state = xcb_get_property(conn, 0, windows[i], ctx.atoms.netWmState,
+                                                        XCB_ATOM_ATOM, 0, ctx.limits.maxStateAtoms);
+            }
+            xcb_flush(conn);
+
+            std::vector<xcb_window_t> kept;
+            kept.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                bool keep = true;
+                if (filter.byDesktop)
+                {
+                    auto reply = WaitReply<xcb_get_property_reply_t>(conn, cookies[i].desktop, wait);
+                    int desktop = DesktopOf(reply.get());
+                    keep = desktop < 0 || static_cast<uint32_t>(desktop) == filter.desktop;
+                }
+                if (filter.ByType())
+                {
+                    auto reply = WaitReply<xcb_get_property_reply_t>(conn, cookies[i].type, wait);
+                    size_t typeCount = 0;
+                    const xcb_atom_t *types = AtomList(reply.get(), typeCount);
+                    keep = keep && !HasFlag(filter.excludeTypes, WindowTypeFromAtoms(types, typeCount, ctx.atoms));
+                }
+                if (filter.ByState())
+                {
+                    auto reply = WaitReply<xcb_get_property_reply_t>(conn, cookies[i].state, wait);
+                    size_t stateCount = 0;
+                    const xcb_atom_t *states = AtomList(reply.get(), stateCount);
+                    for (size_t s = 0; s < stateCount && keep; ++s)
+                    {
+                        keep = !(filter.excludeSkipTaskbar && states[s] == ctx.atoms.netWmStateSkipTaskbar) &&
+                               !(filter.excludeSkipPager && states[s] == ctx.atoms.netWmStateSkipPager);
+                    }
+                }
+                if (keep && !wait.timedOut)
+                {
+                    kept.push_back(windows[i]);
+                }
+            }
+            return kept;
+        }
+
+        void FetchWindowInfo(xcb_connection_t *conn, const FetchContext &ctx, xcb_window_t focused,
+                             const xcb_window_t *windows, size_t count, FetchedWindow *out,
+                             ReplyWait &wait)
+        {
+            std::vector<WindowCookies> cookies(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                cookies[i] = RequestWindowInfo(conn, windows[i], ctx);
+            }
+            xcb_flush(conn);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i].valid = CollectWindowInfo(conn, cookies[i], ctx, focused, out[i].info, wait);
+            }
+        }
+
+        bool StreamWindowInfo(xcb_connection_t *conn, const FetchContext &ctx, xcb_window_t focused,
+                              const xcb_window_t *windows, size_t count, size_t windowAhead, ReplyWait &wait,
+                              FunctionRef<bool(WindowInfo &)> onWindow)
+        {
+            windowAhead = std::max<size_t>(1, windowAhead);
+
+            std::deque<WindowCookies> inFlight;
+            size_t next = 0;
+            WindowInfo info;
+
+            while ((next < count || !inFlight.empty()) && !wait.timedOut)
+            {
+                // Top the in-flight window back up before blocking on the oldest reply
+                if (inFlight.size() < windowAhead && next < count)
+                {
+                    while (inFlight.size() < windowAhead && next < count)
+                    {
+                        inFlight.push_back(RequestWindowInfo(conn, windows[next++], ctx));
+                    }
+                    xcb_flush(conn);
+                }
+
+                WindowCookies cookies = inFlight.front();
+                inFlight.pop_front();
+                if (!CollectWindowInfo(conn, cookies, ctx, focused, info, wait))
+                {
+                    continue;
+                }
+
+                if (!onWindow(info))
+                {
+                    for (const auto &pending : inFlight)
+                    {
+                        DiscardWindowInfo(conn, pending);
+                    }
+                    return false;
+                }
+            }
+
+            for (const auto &pending : inFlight)
+            {
+                DiscardWindowInfo(conn, pending);
+            }
+            return true;
+        }
+
+    } // namespace Xcb
+} // namespace CrossWindow
@@ -0,0 +1,277 @@
+/**
+ * @file XcbPipeline.h
+ * @brief Pipelined X11 requests used by the Linux backend
+ *
+ * Xlib waits for every reply before sending the next request, so walking
+ * many windows costs one round trip each. The helpers here issue a whole
+ * batch of requests over XCB first and only then collect the replies.
+ */
+
+#pragma once
+
+#include "CrossWindow.h"
+#include <xcb/xcb.h>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CrossWindow
+{
+    namespace Xcb
+    {
+
+        /**
+         * @brief Releases memory returned by XCB reply functions
+         */
+        struct FreeDeleter
+        {
+            void operator()(void *p) const { std::free(p); }
+        };
+
+        template <typename T>
+        using Reply = std::unique_ptr<T, FreeDeleter>;
+
+        /**
+         * @brief Shorten text to at most maxBytes without splitting a UTF-8 sequence
+         */
+        void TrimUtf8(std::string &text, size_t maxBytes);
+
+        /**
+         * @brief Decide whether a title read was cut off, and cut it cleanly if so
+         *
+         * bytesAfter only means truncation when the property had the requested
+         * type. STRING (Latin-1) titles are cut by bytes, UTF-8 ones on a
+         * character boundary.
+         * @return true if the title is incomplete
+         */
+        bool TitleCut(xcb_atom_t actualType, xcb_atom_t requestedType, uint32_t bytesAfter, size_t maxBytes,
+                      std::string &title);
+
+        /**
+         * @brief Deadline shared by every wait of one operation
+         *
+         * Once the deadline passes timedOut is set and all further replies are
+         * discarded without waiting, so callers keep whatever completed in time.
+         */
+        struct ReplyWait
+        {
+            Deadline deadline = NoDeadline;
+            bool timedOut = false;
+            bool failed = false; ///< Some request got an error, e.g. BadWindow for a destroyed window
+        };
+
+        /**
+         * @brief Wait for the raw reply to a request, honouring the deadline
+         *
+         * Errors are dropped after setting wait.failed. Once the deadline has passed the request is discarded
+         * and nullptr returned. The result must be released with std::free.
+         */
+        void *WaitForReply(xcb_connection_t *conn, unsigned int sequence, ReplyWait &wait);
+
+        /**
+         * @brief Read _NET_CLIENT_LIST from the root window
+         * @param maxWindows Entries beyond this many are not downloaded
+         * @param out Receives the client windows
+         * @param truncated Set when the list had more than maxWindows entries
+         * @return false if the property does not exist (no EWMH window manager)
+         */
+        bool ReadClientList(xcb_connection_t *conn, xcb_window_t root, xcb_atom_t netClientList,
+                            uint32_t maxWindows, ReplyWait &wait, std::vector<xcb_window_t> &out,
+                            bool *truncated = nullptr);
+
+        /**
+         * @brief Statistics gathered while walking the window tree
+         */
+        struct TreeWalkStats
+        {
+            size_t nodesVisited = 0; ///< Windows whose WM_STATE was checked
+            size_t roundTrips = 0;   ///< Batches sent to the server
+        };
+
+        /**
+         * @brief Find top-level client windows by walking the tree from the root
+         *
+         * Each level of the tree is fetched as one pipelined batch. A subtree stops
+         * being searched as soon as a window carrying WM_STATE is found. Root children
+         * with no WM_STATE anywhere below them (no window manager at all) are reported
+         * themselves when they are viewable, InputOutput and not override-redirect.
+         *
+         * @param conn XCB connection
+         * @param root Root window to start from
+         * @param wmState The WM_STATE atom
+         * @param wait Deadline; on timeout the clients found so far are returned
+         * @param stats Optional statistics output
+         * @return Client windows in root stacking order (bottom to top)
+         */
+        std::vector<xcb_window_t> WalkClientTree(xcb_connection_t *conn, xcb_window_t root,
+                                                 xcb_atom_t wmState, ReplyWait &wait,
+                                                 TreeWalkStats *stats = nullptr);
+
+        /// Number of WindowType values, _NET_WM_WINDOW_TYPE_NORMAL through _DND
+        constexpr size_t kWindowTypeCount = 14;
+
+        /// Atom names of the window types, in WindowType bit order
+        extern const char *const kWindowTypeAtomNames[kWindowTypeCount];
+
+        /**
+         * @brief Atoms needed to decode WindowInfo from raw properties
+         */
+        struct InfoAtoms
+        {
+            xcb_atom_t netWmName = XCB_NONE;
+            xcb_atom_t utf8String = XCB_NONE;
+            xcb_atom_t netWmPid = XCB_NONE;
+            xcb_atom_t netWmState = XCB_NONE;
+            xcb_atom_t netWmStateHidden = XCB_NONE;
+            xcb_atom_t netWmStateMaximizedVert = XCB_NONE;
+            xcb_atom_t netWmStateMaximizedHorz = XCB_NONE;
+            xcb_atom_t netWmStateFullscreen = XCB_NONE;
+            xcb_atom_t netWmStateAbove = XCB_NONE;
+            xcb_atom_t netWmDesktop = XCB_NONE;
+            xcb_atom_t netWmStateSkipTaskbar = XCB_NONE;
+            xcb_atom_t netWmStateSkipPager = XCB_NONE;
+            xcb_atom_t netWmWindowType = XCB_NONE;
+            std::array<xcb_atom_t, kWindowTypeCount> windowTypes{}; ///< Index i is WindowType 1 << i
+        };
+
+        /**
+         * @brief Decode a _NET_WM_WINDOW_TYPE list; the first known type wins
+         * @return WindowType::Normal if none is known
+         */
+        WindowType WindowTypeFromAtoms(const xcb_atom_t *list, size_t count, const InfoAtoms &atoms);
+
+        class PropertyCache;
+
+        /**
+         * @brief Everything a window fetch needs besides the connection
+         */
+        struct FetchContext
+        {
+            xcb_window_t root = XCB_NONE;
+            InfoAtoms atoms;
+            PropertyLimits limits;
+            PropertyCache *cache = nullptr; ///< Receives the properties read, when events for them are selected
+        };
+
+        /**
+         * @brief Outstanding requests for everything WindowInfo needs from the server
+         */
+        struct WindowCookies
+        {
+            xcb_window_t window = XCB_NONE;
+            xcb_get_window_attributes_cookie_t attributes{};
+            xcb_get_geometry_cookie_t geometry{};
+            xcb_translate_coordinates_cookie_t position{};
+            xcb_get_property_cookie_t netWmName{};
+            xcb_get_property_cookie_t wmName{};
+            xcb_get_property_cookie_t wmClass{};
+            xcb_get_property_cookie_t pid{};
+            xcb_get_property_cookie_t state{};
+            xcb_get_property_cookie_t desktop{};
+            xcb_get_property_cookie_t windowType{};
+        };
+
+        /**
+         * @brief Send every request for one window without waiting for replies
+         */
+        WindowCookies RequestWindowInfo(xcb_connection_t *conn, xcb_window_t window,
+                                        const FetchContext &ctx);
+
+        /**
+         * @brief Wait for the replies of RequestWindowInfo and decode them
+         *
+         * processName is left empty; it comes from /proc rather than the server.
+         * Properties are read only up to ctx.limits; a cut-off title sets titleTruncated.
+         *
+         * @param focused Currently active window, used to set WindowState::Focused
+         * @param wait Deadline for the replies
+         * @return false if the window no longer exists or the deadline passed
+         */
+        bool CollectWindowInfo(xcb_connection_t *conn, const WindowCookies &cookies,
+                               const FetchContext &ctx, xcb_window_t focused, WindowInfo &out,
+                               ReplyWait &wait);
+
+        /**
+         * @brief Drop the replies of RequestWindowInfo without waiting for them
+         */
+        void DiscardWindowInfo(xcb_connection_t *conn, const WindowCookies &cookies);
+
+        /**
+         * @brief Read _NET_ACTIVE_WINDOW from the root window
+         */
+        xcb_window_t GetActiveWindow(xcb_connection_t *conn, xcb_window_t root, xcb_atom_t netActiveWindow,
+                                     ReplyWait &wait);
+
+        /**
+         * @brief Read a single CARDINAL from a window property
+         * @return fallback if the property is missing or the deadline passed
+         */
+        uint32_t ReadCardinal(xcb_connection_t *conn, xcb_window_t window, xcb_atom_t property,
+                              uint32_t fallback, ReplyWait &wait);
+
+        /**
+         * @brief Cheap per-window checks applied before the full fetch
+         */
+        struct WindowFilter
+        {
+            bool byDesktop = false;
+            uint32_t desktop = 0; ///< Desktop to keep; sticky windows always pass
+            WindowType excludeTypes{};
+            bool excludeSkipTaskbar = false;
+            bool excludeSkipPager = false;
+
+            bool ByType() const { return static_cast<uint32_t>(excludeTypes) != 0; }
+            bool ByState() const { return excludeSkipTaskbar || excludeSkipPager; }
+            bool IsActive() const { return byDesktop || ByType() || ByState(); }
+        };
+
+        /**
+         * @brief Drop windows that fail the filter, fetching only what the filter needs
+         *
+         * At most one small request per window and criterion, all pipelined.
+         * Windows without _NET_WM_DESKTOP pass the desktop check; windows without
+         * a type count as Normal.
+         *
+         * @return Surviving windows, in input order
+         */
+        std::vector<xcb_window_t> FilterWindows(xcb_connection_t *conn, const FetchContext &ctx,
+                                                const xcb_window_t *windows, size_t count,
+                                                const WindowFilter &filter, ReplyWait &wait);
+
+        /**
+         * @brief WindowInfo plus whether the window still existed when fetched
+         */
+        struct FetchedWindow
+        {
+            WindowInfo info;
+            bool valid = false;
+        };
+
+        /**
+         * @brief Fetch WindowInfo for a list of windows with all requests pipelined
+         * @param out Receives one entry per input window, in input order; windows not
+         *            fetched before the deadline are left invalid
+         */
+        void FetchWindowInfo(xcb_connection_t *conn, const FetchContext &ctx, xcb_window_t focused,
+                             const xcb_window_t *windows, size_t count, FetchedWindow *out,
+                             ReplyWait &wait);
+
+        /**
+         * @brief Stream WindowInfo to a callback with a bounded number of windows in flight
+         *
+         * Requests for up to windowAhead windows are outstanding at any time. Each window
+         * is handed to onWindow as soon as its replies are in, in input order. Windows that
+         * no longer exist are skipped. When onWindow returns false, or the deadline
+         * passes, the outstanding replies are discarded and nothing further is requested.
+         *
+         * @return false if onWindow stopped the enumeration
+         */
+        bool StreamWindowInfo(xcb_connection_t *conn, const FetchContext &ctx, xcb_window_t focused,
+                              const xcb_window_t *windows, size_t count, size_t windowAhead, ReplyWait &wait,
+                              FunctionRef<bool(WindowInfo &)> onWindow);
+
+    } // namespace Xcb
+} // namespace CrossWindow
@@ -10,7 +10,7 @@
 namespace CrossWindow
 {
 
-    class WindowManagerMacOS : public WindowManagerImplBase
+    class WindowManagerMacOS final : public WindowManagerImplBase
     {
     public:
         WindowManagerMacOS();
@@ -22,7 +22,7 @@ namespace CrossWindow
 
         // Enumeration
         std::vector<WindowInfo> GetAllWindows() override;
-        void EnumerateWindows(const EnumWindowsCallback &callback) override;
+        void EnumerateWindows(WindowCallbackRef callback) override;
         std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern,
                                                    bool caseSensitive) override;
         std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName) override;
@@ -56,8 +56,8 @@ namespace CrossWindow
         ErrorCode SetWindowTitle(NativeHandle handle, const std::string &title) override;
         ErrorCode SetWindowOpacity(NativeHandle handle, float opacity) override;
 
-        std::string GetLastError() const override;
-        void SetLastError(const std::string &error) override;
+        ErrorMessage GetLastError() const override;
+        void SetLastError(ErrorMessage error) override;
 
     private:
         bool ToLowerCompare(const std::string &str, const std::string &pattern);
@@ -27,7 +27,7 @@ namespace CrossWindow
         
         if (!trusted)
         {
-            SetLastError("Accessibility permissions required. Please grant access in System Preferences.");
+            SetLastError("Accessibility permissions required. Please grant access in System Preferences."_msg);
             // Still allow initialization, but some features may not work
         }
         
@@ -60,7 +60,7 @@ namespace CrossWindow
         
         if (!m_initialized)
         {
-            SetLastError("WindowManager not initialized");
+            SetLastError("WindowManager not initialized"_msg);
             return result;
         }
 
@@ -98,6 +98,8 @@ namespace CrossWindow
                 {
                     info.processName = [ownerName UTF8String];
                     info.className = info.processName;
+                    info.processNameId = StringPool::Intern(info.processName);
+                    info.classNameId = info.processNameId;
                 }
                 
                 // Get process ID
@@ -131,7 +133,7 @@ namespace CrossWindow
         return result;
     }
 
-    void WindowManagerMacOS::EnumerateWindows(const EnumWindowsCallback &callback)
+    void WindowManagerMacOS::EnumerateWindows(WindowCallbackRef callback)
     {
         if (!m_initialized)
         {
@@ -208,7 +210,7 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
@@ -223,7 +225,7 @@ namespace CrossWindow
             {
                 if (windowList) CFRelease(windowList);
                 result.error = ErrorCode::InvalidHandle;
-                result.errorMessage = "Invalid window handle";
+                result.errorMessage = "Invalid window handle"_msg;
                 return result;
             }
             
@@ -243,6 +245,8 @@ namespace CrossWindow
             {
                 result.value.processName = [ownerName UTF8String];
                 result.value.className = result.value.processName;
+                result.value.processNameId = StringPool::Intern(result.value.processName);
+                result.value.classNameId = result.value.processNameId;
             }
             
             NSNumber *pid = window[(id)kCGWindowOwnerPID];
@@ -409,7 +413,7 @@ namespace CrossWindow
         {
             Result<WindowInfo> result;
             result.error = ErrorCode::WindowNotFound;
-            result.errorMessage = "No focused window found";
+            result.errorMessage = "No focused window found"_msg;
             return result;
         }
         return GetWindowInfo(focused);
@@ -656,7 +660,7 @@ namespace CrossWindow
     {
         // macOS doesn't have a simple always-on-top for other applications' windows
         // This would require the application itself to set the window level
-        SetLastError("SetAlwaysOnTop not supported for external windows on macOS");
+        SetLastError("SetAlwaysOnTop not supported for external windows on macOS"_msg);
         return ErrorCode::NotSupported;
     }
 
@@ -769,25 +773,25 @@ namespace CrossWindow
     ErrorCode WindowManagerMacOS::SetWindowTitle(NativeHandle handle, const std::string &title)
     {
         // Cannot set window title for external applications on macOS
-        SetLastError("SetWindowTitle not supported for external windows on macOS");
+        SetLastError("SetWindowTitle not supported for external windows on macOS"_msg);
         return ErrorCode::NotSupported;
     }
 
     ErrorCode WindowManagerMacOS::SetWindowOpacity(NativeHandle handle, float opacity)
     {
         // Cannot set window opacity for external applications on macOS
-        SetLastError("SetWindowOpacity not supported for external windows on macOS");
+        SetLastError("SetWindowOpacity not supported for external windows on macOS"_msg);
         return ErrorCode::NotSupported;
     }
 
-    std::string WindowManagerMacOS::GetLastError() const
+    ErrorMessage WindowManagerMacOS::GetLastError() const
     {
         return m_lastError;
     }
 
-    void WindowManagerMacOS::SetLastError(const std::string &error)
+    void WindowManagerMacOS::SetLastError(ErrorMessage error)
     {
-        m_lastError = error;
+        m_lastError = std::move(error);
     }
 
 } // namespace CrossWindow
@@ -10,7 +10,7 @@
 namespace CrossWindow
 {
 
-    class WindowManagerStub : public WindowManagerImplBase
+    class WindowManagerStub final : public WindowManagerImplBase
     {
     public:
         WindowManagerStub() = default;
@@ -18,7 +18,7 @@ namespace CrossWindow
 
         bool Initialize() override
         {
-            SetLastError("Platform not supported");
+            SetLastError("Platform not supported"_msg);
             return false;
         }
 
@@ -26,33 +26,33 @@ namespace CrossWindow
         void Shutdown() override {}
 
         std::vector<WindowInfo> GetAllWindows() override { return {}; }
-        void EnumerateWindows(const EnumWindowsCallback &) override {}
+        void EnumerateWindows(WindowCallbackRef) override {}
         std::vector<WindowInfo> FindWindowsByTitle(const std::string &, bool) override { return {}; }
         std::vector<WindowInfo> FindWindowsByProcess(const std::string &) override { return {}; }
 
         Result<WindowInfo> GetWindowInfo(NativeHandle) override
         {
-            return {WindowInfo{}, ErrorCode::NotSupported, "Platform not supported"};
+            return {WindowInfo{}, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         Result<std::string> GetWindowTitle(NativeHandle) override
         {
-            return {std::string{}, ErrorCode::NotSupported, "Platform not supported"};
+            return {std::string{}, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         Result<Rect> GetWindowRect(NativeHandle) override
         {
-            return {Rect{}, ErrorCode::NotSupported, "Platform not supported"};
+            return {Rect{}, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         Result<WindowState> GetWindowState(NativeHandle) override
         {
-            return {WindowState::Normal, ErrorCode::NotSupported, "Platform not supported"};
+            return {WindowState::Normal, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         Result<uint32_t> GetWindowProcessId(NativeHandle) override
         {
-            return {0, ErrorCode::NotSupported, "Platform not supported"};
+            return {0, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         bool IsWindowVisible(NativeHandle) override { return false; }
@@ -61,7 +61,7 @@ namespace CrossWindow
         NativeHandle GetFocusedWindow() override { return NativeHandle{}; }
         Result<WindowInfo> GetFocusedWindowInfo() override
         {
-            return {WindowInfo{}, ErrorCode::NotSupported, "Platform not supported"};
+            return {WindowInfo{}, ErrorCode::NotSupported, "Platform not supported"_msg};
         }
 
         ErrorCode CloseWindow(NativeHandle) override { return ErrorCode::NotSupported; }
@@ -79,8 +79,8 @@ namespace CrossWindow
         ErrorCode SetWindowTitle(NativeHandle, const std::string &) override { return ErrorCode::NotSupported; }
         ErrorCode SetWindowOpacity(NativeHandle, float) override { return ErrorCode::NotSupported; }
 
-        std::string GetLastError() const override { return m_lastError; }
-        void SetLastError(const std::string &error) override { m_lastError = error; }
+        ErrorMessage GetLastError() const override { return m_lastError; }
+        void SetLastError(ErrorMessage error) override { m_lastError = std::move(error); }
     };
 
 } // namespace CrossWindow
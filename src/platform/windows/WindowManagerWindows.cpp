@@ -17,7 +17,7 @@ namespace CrossWindow
     {
         std::vector<WindowInfo> *windows;
         WindowManagerWindows *manager;
-        const EnumWindowsCallback *callback;
+        const WindowCallbackRef *callback;
         bool continueEnum;
     };
 
@@ -171,7 +171,7 @@ namespace CrossWindow
 
         if (!m_initialized)
         {
-            SetLastError("WindowManager not initialized");
+            SetLastError("WindowManager not initialized"_msg);
             return result;
         }
 
@@ -186,7 +186,7 @@ namespace CrossWindow
         return result;
     }
 
-    void WindowManagerWindows::EnumerateWindows(const EnumWindowsCallback &callback)
+    void WindowManagerWindows::EnumerateWindows(WindowCallbackRef callback)
     {
         if (!m_initialized)
         {
@@ -263,26 +263,28 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
         if (!IsWindow(hwnd))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
         result.value.handle = handle;
         result.value.title = GetWindowTitleInternal(hwnd);
         result.value.className = GetWindowClassInternal(hwnd);
+        result.value.classNameId = StringPool::Intern(result.value.className);
 
         // Get process ID
         DWORD pid = 0;
         GetWindowThreadProcessId(hwnd, &pid);
         result.value.processId = pid;
         result.value.processName = GetProcessNameFromPid(pid);
+        result.value.processNameId = StringPool::Intern(result.value.processName);
 
         // Get rect
         RECT rect;
@@ -336,14 +338,14 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
         if (!IsWindow(hwnd))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
@@ -360,14 +362,14 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
         if (!IsWindow(hwnd))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
@@ -383,7 +385,7 @@ namespace CrossWindow
         else
         {
             result.error = ErrorCode::OperationFailed;
-            result.errorMessage = "Failed to get window rect";
+            result.errorMessage = "Failed to get window rect"_msg;
         }
 
         return result;
@@ -397,14 +399,14 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
         if (!IsWindow(hwnd))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
@@ -446,14 +448,14 @@ namespace CrossWindow
         if (!m_initialized)
         {
             result.error = ErrorCode::NotInitialized;
-            result.errorMessage = "WindowManager not initialized";
+            result.errorMessage = "WindowManager not initialized"_msg;
             return result;
         }
 
         if (!IsWindow(hwnd))
         {
             result.error = ErrorCode::InvalidHandle;
-            result.errorMessage = "Invalid window handle";
+            result.errorMessage = "Invalid window handle"_msg;
             return result;
         }
 
@@ -498,7 +500,7 @@ namespace CrossWindow
         {
             Result<WindowInfo> result;
             result.error = ErrorCode::WindowNotFound;
-            result.errorMessage = "No focused window found";
+            result.errorMessage = "No focused window found"_msg;
             return result;
         }
         return GetWindowInfo(focused);
@@ -780,14 +782,14 @@ namespace CrossWindow
         return ErrorCode::Success;
     }
 
-    std::string WindowManagerWindows::GetLastError() const
+    ErrorMessage WindowManagerWindows::GetLastError() const
     {
         return m_lastError;
     }
 
-    void WindowManagerWindows::SetLastError(const std::string &error)
+    void WindowManagerWindows::SetLastError(ErrorMessage error)
     {
-        m_lastError = error;
+        m_lastError = std::move(error);
     }
 
 } // namespace CrossWindow
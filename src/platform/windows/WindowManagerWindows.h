@@ -19,7 +19,7 @@
 namespace CrossWindow
 {
 
-    class WindowManagerWindows : public WindowManagerImplBase
+    class WindowManagerWindows final : public WindowManagerImplBase
     {
     public:
         WindowManagerWindows();
@@ -31,7 +31,7 @@ namespace CrossWindow
 
         // Enumeration
         std::vector<WindowInfo> GetAllWindows() override;
-        void EnumerateWindows(const EnumWindowsCallback &callback) override;
+        void EnumerateWindows(WindowCallbackRef callback) override;
         std::vector<WindowInfo> FindWindowsByTitle(const std::string &titlePattern,
                                                    bool caseSensitive) override;
         std::vector<WindowInfo> FindWindowsByProcess(const std::string &processName) override;
@@ -65,8 +65,8 @@ namespace CrossWindow
         ErrorCode SetWindowTitle(NativeHandle handle, const std::string &title) override;
         ErrorCode SetWindowOpacity(NativeHandle handle, float opacity) override;
 
-        std::string GetLastError() const override;
-        void SetLastError(const std::string &error) override;
+        ErrorMessage GetLastError() const override;
+        void SetLastError(ErrorMessage error) override;
 
     private:
         std::string GetWindowTitleInternal(HWND hwnd);
@@ -4,8 +4,21 @@
  */
 
 #include "CrossWindow.h"
+#include "ChangeLog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cassert>
+#ifdef CROSSWINDOW_LINUX
+#include <X11/Xlib.h>
+#ifdef CROSSWINDOW_HAVE_X11_XCB
+#include <X11/Xlib-xcb.h>
+#endif
+// X11 macros that clash with ErrorCode::Success and WindowField::None
+#undef Success
+#undef None
+#endif
 
 using namespace CrossWindow;
 
@@ -15,6 +28,115 @@ int main()
     std::cout << "======================\n";
     std::cout << "Platform: " << WindowManager::GetPlatformName() << "\n\n";
 
+    // Test the change log on synthetic snapshots; needs no display
+    std::cout << "Test: ChangeLog... ";
+    {
+        auto window = [](uint64_t handle, uint64_t generation, const char *title)
+        {
+            WindowInfo info;
+            info.handle = static_cast<NativeHandle>(handle);
+            info.generation = generation;
+            info.title = title;
+            return info;
+        };
+        using Kind = WindowChange::Kind;
+
+        ChangeLog log;
+        log.Update({window(1, 1, "a"), window(2, 1, "b")});
+        assert(log.Generation() == 1);
+        assert(log.Since(0).fullSnapshot && log.Since(0).snapshot.size() == 2);
+        assert(!log.Since(1).fullSnapshot && log.Since(1).changes.empty());
+
+        // Modify: only the differing field is reported
+        log.Update({window(1, 1, "a2"), window(2, 1, "b")});
+        assert(log.Generation() == 2);
+        WindowChanges modified = log.Since(1);
+        assert(modified.generation == 2 && modified.changes.size() == 1);
+        assert(modified.changes[0].kind == Kind::Modified);
+        assert(modified.changes[0].window.handle == static_cast<NativeHandle>(1));
+        assert(modified.changes[0].fields == WindowField::Title);
+        assert(modified.changes[0].window.title == "a2");
+
+        // Add, then remove: each on its own, nothing when folded together
+        log.Update({window(1, 1, "a2"), window(2, 1, "b"), window(3, 1, "c")});
+        WindowChanges added = log.Since(2);
+        assert(added.changes.size() == 1 && added.changes[0].kind == Kind::Added);
+        assert(added.changes[0].window.handle == static_cast<NativeHandle>(3));
+        assert(added.changes[0].fields == WindowField::All);
+        log.Update({window(1, 1, "a2"), window(2, 1, "b")});
+        WindowChanges removed = log.Since(3);
+        assert(removed.changes.size() == 1 && removed.changes[0].kind == Kind::Removed);
+        assert(removed.changes[0].window.handle == static_cast<NativeHandle>(3));
+        assert(log.Since(2).changes.empty());
+
+        // An unchanged list does not advance the generation
+        log.Update({window(1, 1, "a2"), window(2, 1, "b")});
+        assert(log.Generation() == 4);
+
+        // Remove, and reuse handle 1 for another window
+        log.Update({window(1, 2, "new")});
+        assert(log.Generation() == 5);
+        WindowChanges reused = log.Since(4);
+        const NativeHandle first = static_cast<NativeHandle>(1);
+        const NativeHandle second = static_cast<NativeHandle>(2);
+        assert(reused.changes.size() == 3);
+        assert(reused.changes[0].kind == Kind::Removed && reused.changes[0].window.handle == first);
+        assert(reused.changes[1].kind == Kind::Added && reused.changes[1].window.title == "new");
+        assert(reused.changes[2].kind == Kind::Removed && reused.changes[2].window.handle == second);
+
+        // From the start: the modification folds into the removal, the reuse still reads as added
+        WindowChanges all = log.Since(1);
+        assert(all.changes.size() == 3);
+        assert(all.changes[0].kind == Kind::Removed && all.changes[0].window.handle == first);
+        assert(all.changes[1].kind == Kind::Added && all.changes[1].window.generation == 2);
+        assert(all.changes[2].kind == Kind::Removed && all.changes[2].window.handle == second);
+
+        // A log that dropped entries answers with a snapshot
+        ChangeLog small(1);
+        small.Update({window(1, 1, "a")});
+        small.Update({window(1, 1, "a"), window(2, 1, "b")});
+        small.Update({window(1, 1, "a"), window(2, 1, "b"), window(3, 1, "c")});
+        assert(!small.Since(2).fullSnapshot && small.Since(2).changes.size() == 1);
+        assert(small.Since(1).fullSnapshot && small.Since(1).snapshot.size() == 3);
+    }
+    std::cout << "PASSED\n";
+
+    // Test error messages: literals and formatted text read back the same way; needs no display
+    std::cout << "Test: ErrorMessage... ";
+    {
+        Result<int> failed;
+        assert(failed.errorMessage.empty());
+        failed.errorMessage = "Invalid window handle"_msg;
+        assert(failed.errorMessage == "Invalid window handle");
+        Result<int> copy = failed;
+        assert(copy.errorMessage.c_str() == failed.errorMessage.c_str());
+        copy.errorMessage = std::string("Window ") + std::to_string(42) + " is gone";
+        assert(copy.errorMessage == "Window 42 is gone");
+        assert(std::string(copy.errorMessage.c_str()) == "Window 42 is gone");
+        std::string text = failed.errorMessage;
+        assert(text == "Invalid window handle");
+        {
+            // A C string that is not a literal is copied, so it may go away
+            std::string scratch = "Display closed";
+            copy.errorMessage = scratch.c_str();
+            scratch.assign(scratch.size(), 'x');
+        }
+        assert(copy.errorMessage == "Display closed");
+
+        // So is a char array, which is no literal either, and only up to its terminator
+        auto format = [](int window)
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "Window %d gone", window);
+            return ErrorMessage(buffer);
+        };
+        ErrorMessage formatted = format(7);
+        char clobber[64];
+        std::memset(clobber, 'x', sizeof(clobber));
+        assert(formatted == "Window 7 gone" && formatted.size() == 13 && clobber[0] == 'x');
+    }
+    std::cout << "PASSED\n";
+
     WindowManager wm;
 
     // Test initialization
@@ -30,6 +152,7 @@ int main()
     // Test IsInitialized
     std::cout << "Test: IsInitialized... ";
     assert(wm.IsInitialized());
+    assert(wm.IsConnected());
     std::cout << "PASSED\n";
 
     // Test GetAllWindows
@@ -37,6 +160,63 @@ int main()
     auto windows = wm.GetAllWindows();
     std::cout << "PASSED (found " << windows.size() << " windows)\n";
 
+    // Test GetAllWindows with parallel workers (same windows, same order)
+    std::cout << "Test: GetAllWindows (4 workers)... ";
+    EnumerationOptions parallelOptions;
+    parallelOptions.workerCount = 4;
+    auto parallelWindows = wm.GetAllWindows(parallelOptions);
+    assert(parallelWindows.size() == windows.size());
+    for (size_t i = 0; i < windows.size(); ++i)
+    {
+        const WindowInfo &a = windows[i];
+        const WindowInfo &b = parallelWindows[i];
+        assert(a.handle == b.handle && a.generation == b.generation);
+        assert(a.title == b.title && a.titleTruncated == b.titleTruncated && a.className == b.className);
+        assert(a.rect.x == b.rect.x && a.rect.y == b.rect.y && a.rect.width == b.rect.width &&
+               a.rect.height == b.rect.height);
+        assert(a.state == b.state && a.isVisible == b.isVisible && a.type == b.type);
+        assert(a.processId == b.processId && a.processName == b.processName);
+        assert(a.desktop == b.desktop && a.monitor == b.monitor);
+        assert(a.skipTaskbar == b.skipTaskbar && a.skipPager == b.skipPager);
+    }
+    std::cout << "PASSED (found " << parallelWindows.size() << " windows)\n";
+
+    // Test GetAllWindows with a generous deadline (complete, not partial)
+    std::cout << "Test: GetAllWindows (deadline)... ";
+    EnumerationOptions deadlineOptions;
+    deadlineOptions.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto boundedWindows = wm.GetAllWindows(deadlineOptions);
+    assert(!wm.WasLastEnumerationPartial());
+    std::cout << "PASSED (found " << boundedWindows.size() << " windows)\n";
+
+    // Test property limits cap title length
+    std::cout << "Test: SetPropertyLimits... ";
+    PropertyLimits limits;
+    limits.maxTitleBytes = 8;
+    wm.SetPropertyLimits(limits);
+    assert(wm.GetPropertyLimits().maxTitleBytes == 8);
+#ifdef CROSSWINDOW_LINUX
+    for (const auto &w : wm.GetAllWindows())
+    {
+        assert(w.title.size() <= 8);
+    }
+#endif
+    wm.SetPropertyLimits(PropertyLimits{});
+    std::cout << "PASSED\n";
+
+    // Test GetLastEnumerationStrategy
+    std::cout << "Test: GetLastEnumerationStrategy... ";
+    auto strategy = wm.GetLastEnumerationStrategy();
+#ifdef CROSSWINDOW_LINUX
+    assert(strategy == EnumerationStrategy::ClientList || strategy == EnumerationStrategy::TreeWalk);
+#else
+    assert(strategy == EnumerationStrategy::Native);
+#endif
+    std::cout << "PASSED (" << (strategy == EnumerationStrategy::TreeWalk     ? "TreeWalk"
+                                : strategy == EnumerationStrategy::ClientList ? "ClientList"
+                                                                              : "Native")
+              << ")\n";
+
     // Test GetFocusedWindow
     std::cout << "Test: GetFocusedWindow... ";
     auto focused = wm.GetFocusedWindow();
@@ -57,12 +237,294 @@ int main()
         std::cout << "PASSED (no focused window)\n";
     }
 
+    // Test single-window query with a deadline
+    std::cout << "Test: GetWindowInfo (deadline)... ";
+    if (!windows.empty())
+    {
+        Deadline later = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        auto bounded = wm.GetWindowInfo(windows.front().handle, later);
+        assert(bounded.ok() || bounded.error == ErrorCode::InvalidHandle);
+        if (bounded.ok())
+        {
+            // The single-field reads agree with the full one
+            auto title = wm.GetWindowTitle(bounded.value.handle, later);
+            auto rect = wm.GetWindowRect(bounded.value.handle, later);
+            auto pid = wm.GetWindowProcessId(bounded.value.handle, later);
+            assert(!title.ok() || title.value == bounded.value.title);
+            assert(!rect.ok() || rect.value.width == bounded.value.rect.width);
+            assert(!pid.ok() || pid.value == bounded.value.processId);
+        }
+        assert(wm.GetWindowTitle(NativeHandle{}, later).error != ErrorCode::Success);
+        auto boundedFocus = wm.GetFocusedWindowInfo(later);
+        assert(boundedFocus.ok() || boundedFocus.error == ErrorCode::WindowNotFound ||
+               boundedFocus.error == ErrorCode::InvalidHandle);
+        auto byTitle = wm.FindWindowsByTitle(bounded.value.title, true, later);
+        assert(!bounded.ok() || bounded.value.title.empty() || !byTitle.empty());
+        std::cout << "PASSED\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no windows)\n";
+    }
+
+    // Test window ids: an id handed out is current, the same handle with another generation is not
+    std::cout << "Test: WindowId... ";
+    if (!windows.empty())
+    {
+        WindowId id{windows.front().handle, windows.front().generation};
+        if (wm.IsCurrentWindow(id))
+        {
+#ifdef CROSSWINDOW_LINUX
+            assert(id.generation != 0);
+            assert(wm.GetWindowId(id.handle) == id);
+            assert(!wm.IsCurrentWindow(WindowId{id.handle, id.generation + 1000000}));
+            assert(wm.FocusWindow(WindowId{id.handle, id.generation + 1000000}) == ErrorCode::WindowNotFound);
+#endif
+            assert(wm.GetWindowInfo(id).ok() || wm.GetWindowInfo(id).error == ErrorCode::InvalidHandle);
+        }
+        std::cout << "PASSED\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no windows)\n";
+    }
+
+    // Test repeated property reads: a second read (served from the cache on Linux) agrees with the first
+    std::cout << "Test: GetWindowTitle (repeated)... ";
+    if (!windows.empty())
+    {
+        auto firstTitle = wm.GetWindowTitle(windows.front().handle);
+        auto secondTitle = wm.GetWindowTitle(windows.front().handle);
+        assert(firstTitle.ok() == secondTitle.ok());
+        if (firstTitle.ok())
+        {
+            assert(firstTitle.value == secondTitle.value);
+            assert(wm.GetWindowState(windows.front().handle).ok());
+        }
+        std::cout << "PASSED\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no windows)\n";
+    }
+
+    // Test generic properties: one batched read per property, typed on the way out
+    std::cout << "Test: GetProperty... ";
+    if (!windows.empty())
+    {
+        std::vector<NativeHandle> handles;
+        for (const auto &w : windows)
+        {
+            handles.push_back(w.handle);
+        }
+        auto classes = wm.GetProperties<std::vector<std::string>>(handles, "WM_CLASS");
+        assert(classes.size() == handles.size());
+#ifdef CROSSWINDOW_LINUX
+        auto unset = wm.GetWindowProperty(handles.front(), "_CROSSWINDOW_TEST_UNSET");
+        assert(!unset.ok() || !unset.value.exists());
+        assert(wm.GetProperty<uint32_t>(handles.front(), "_CROSSWINDOW_TEST_UNSET").error != ErrorCode::Success);
+        int watch = wm.WatchProperty(handles.front(), "WM_NAME", [](NativeHandle, const std::string &) {});
+        if (watch != 0)
+        {
+            wm.PollEvents();
+            assert(wm.UnwatchProperty(watch));
+            assert(!wm.UnwatchProperty(watch));
+        }
+#endif
+        std::cout << "PASSED\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no windows)\n";
+    }
+
+    // Test change tracking: the first call is a snapshot, a later call only carries differences
+    std::cout << "Test: GetChangesSince... ";
+    {
+        WindowChanges initial = wm.GetChangesSince(0);
+        assert(initial.fullSnapshot);
+        assert(initial.changes.empty());
+        WindowChanges later = wm.GetChangesSince(initial.generation);
+        assert(!later.fullSnapshot);
+        assert(later.generation >= initial.generation);
+        for (const auto &change : later.changes)
+        {
+            assert(change.kind == WindowChange::Kind::Removed || change.fields != WindowField::None);
+        }
+        std::cout << "PASSED (" << initial.snapshot.size() << " windows, " << later.changes.size()
+                  << " changes)\n";
+    }
+
+    // Test name interning: ids read back as the names they stand for, equal names share an id
+    std::cout << "Test: StringPool... ";
+    {
+        assert(StringPool::Intern("") == 0);
+        StringId id = StringPool::Intern("crosswindow-test");
+        assert(StringPool::Intern(std::string("crosswindow-") + "test") == id);
+        assert(StringPool::View(id) == "crosswindow-test");
+        for (const auto &info : windows)
+        {
+            assert(StringPool::View(info.processNameId) == info.processName);
+            assert(StringPool::View(info.classNameId) == info.className);
+        }
+        std::cout << "PASSED\n";
+    }
+
+    // Test the column table: rows read back as the windows they came from, filters agree with a plain loop
+    std::cout << "Test: GetWindowTable... ";
+    {
+        WindowTable table = wm.GetWindowTable();
+        size_t visibleRows = 0;
+        size_t overlapping = 0;
+        Rect area{0, 0, 1 << 20, 1 << 20};
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            WindowInfo row = table.Row(i);
+            assert(row.handle == table.handles[i]);
+            assert(row.title == table.Title(i));
+            assert(row.processName == table.ProcessName(i));
+            visibleRows += row.isVisible ? 1 : 0;
+            overlapping += row.rect.width > 0 && row.rect.height > 0 && row.rect.x < area.width &&
+                                   row.rect.x + row.rect.width > 0 && row.rect.y < area.height &&
+                                   row.rect.y + row.rect.height > 0
+                               ? 1
+                               : 0;
+        }
+        assert(table.Visible().size() == visibleRows);
+        assert(table.Intersecting(area).size() == overlapping);
+        assert(table.WithState(WindowState::Normal).size() == table.size());
+        assert(table.WithState(WindowState::Minimized).size() +
+                   table.WithoutState(WindowState::Minimized).size() ==
+               table.size());
+        std::cout << "PASSED (" << table.size() << " rows)\n";
+    }
+
     // Test FindWindowsByTitle
     std::cout << "Test: FindWindowsByTitle... ";
     // Search for a common window (empty string matches all)
     auto searchResult = wm.FindWindowsByTitle("", false);
     std::cout << "PASSED (found " << searchResult.size() << " matches)\n";
 
+    // Test cgroup attribution: every window's own cgroup must find it again
+    std::cout << "Test: FindWindowsByCgroup... ";
+    EnumerationOptions cgroupOptions;
+    cgroupOptions.includeCgroup = true;
+    auto cgroupWindows = wm.GetAllWindows(cgroupOptions);
+    if (!cgroupWindows.empty() && !cgroupWindows.front().cgroupPath.empty())
+    {
+        auto sameCgroup = wm.FindWindowsByCgroup(cgroupWindows.front().cgroupPath);
+        assert(!sameCgroup.empty());
+        std::cout << "PASSED (" << cgroupWindows.front().cgroupPath << ")\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no cgroup information)\n";
+    }
+
+    // Test resource sampling: the second pass has a CPU% delta for every sampled process
+    std::cout << "Test: GetWindowResourceUsage... ";
+    auto firstUsage = wm.GetWindowResourceUsage();
+    {
+        // Let some CPU time pass between the samples
+        volatile uint64_t spin = 0;
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        while (std::chrono::steady_clock::now() < until)
+        {
+            spin = spin + 1;
+        }
+    }
+    auto usage = wm.GetWindowResourceUsage();
+    for (const auto &entry : usage)
+    {
+        if (entry.usage.processId == 0)
+        {
+            continue;
+        }
+        assert(entry.usage.residentBytes > 0);
+        auto history = wm.GetProcessUsageHistory(entry.usage.processId);
+        assert(!history.empty());
+        bool sampledBefore = std::any_of(firstUsage.begin(), firstUsage.end(), [&](const WindowResourceUsage &u)
+                                         { return u.usage.processId == entry.usage.processId; });
+        if (sampledBefore && history.size() >= 2)
+        {
+            const ResourceUsage &previous = history[history.size() - 2];
+            assert(entry.usage.cpuPercent >= 0);
+            assert(entry.usage.cpuTimeMs >= previous.cpuTimeMs);
+            assert(entry.usage.sampledAt > previous.sampledAt);
+        }
+    }
+    std::cout << "PASSED (" << usage.size() << " windows)\n";
+
+    // Test application grouping: a root's tree holds at least its grouped windows
+    std::cout << "Test: GroupWindowsByApplication... ";
+    auto groups = wm.GroupWindowsByApplication();
+    size_t grouped = 0;
+    for (const auto &group : groups)
+    {
+        grouped += group.windows.size();
+        if (group.rootProcessId != 0)
+        {
+            assert(wm.FindWindowsByProcessTree(group.rootProcessId).size() >= group.windows.size());
+        }
+    }
+    std::cout << "PASSED (" << grouped << " windows in " << groups.size() << " applications)\n";
+
+    // Test desktop filtering: only windows on the active desktop (or sticky ones) come back
+    std::cout << "Test: GetAllWindows (current desktop)... ";
+    int currentDesktop = wm.GetCurrentDesktop();
+    if (currentDesktop >= 0)
+    {
+        assert(currentDesktop < wm.GetDesktopCount());
+        EnumerationOptions desktopOptions;
+        desktopOptions.desktop = CurrentDesktop;
+        for (const auto &w : wm.GetAllWindows(desktopOptions))
+        {
+            assert(w.desktop == currentDesktop || w.desktop == -1);
+        }
+        std::cout << "PASSED (desktop " << currentDesktop << ")\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no virtual desktops)\n";
+    }
+
+    // Test type filtering: excluded types never come back
+    std::cout << "Test: GetAllWindows (exclude types)... ";
+    EnumerationOptions typeOptions;
+    typeOptions.excludeTypes = WindowType::Dock | WindowType::Desktop | WindowType::Tooltip;
+    typeOptions.excludeSkipTaskbar = true;
+    for (const auto &w : wm.GetAllWindows(typeOptions))
+    {
+        assert(!HasFlag(typeOptions.excludeTypes, w.type));
+        assert(!w.skipTaskbar);
+    }
+    std::cout << "PASSED\n";
+
+    // Test monitors: every window's monitor index refers to the cached list
+    std::cout << "Test: GetMonitors... ";
+    auto monitors = wm.GetMonitors();
+    if (!monitors.empty())
+    {
+        for (const auto &m : monitors)
+        {
+            assert(m.rect.width > 0 && m.rect.height > 0);
+        }
+        size_t onMonitors = 0;
+        for (size_t i = 0; i < monitors.size(); ++i)
+        {
+            for (const auto &w : wm.FindWindowsOnMonitor(static_cast<int>(i)))
+            {
+                assert(w.monitor == static_cast<int>(i));
+                onMonitors++;
+            }
+        }
+        std::cout << "PASSED (" << monitors.size() << " monitors, " << onMonitors << " windows on them)\n";
+    }
+    else
+    {
+        std::cout << "SKIPPED (no monitor information)\n";
+    }
+
     // Test window enumeration
     std::cout << "Test: EnumerateWindows... ";
     int count = 0;
@@ -73,6 +535,98 @@ int main()
                         });
     std::cout << "PASSED (enumerated " << count << " windows)\n";
 
+    // Test streaming enumeration stops as soon as the callback returns false
+    std::cout << "Test: EnumerateWindows (early stop)... ";
+    EnumerationOptions streamOptions;
+    streamOptions.windowAhead = 4;
+    int streamed = 0;
+    wm.EnumerateWindows([&streamed](const WindowInfo &)
+                        {
+                            streamed++;
+                            return false; // stop after the first window
+                        },
+                        streamOptions);
+    assert(streamed <= 1);
+    std::cout << "PASSED\n";
+
+    // Test batched enumeration: chunks respect batchSize and a stop ends it after the first chunk
+    std::cout << "Test: EnumerateWindowBatches... ";
+    EnumerationOptions batchOptions;
+    batchOptions.batchSize = 3;
+    size_t batched = 0;
+    int batches = 0;
+    wm.EnumerateWindowBatches([&](const WindowInfo *chunk, size_t chunkSize)
+                              {
+                                  assert(chunkSize > 0 && chunkSize <= 3);
+                                  assert(chunk[chunkSize - 1].handle != NativeHandle{});
+                                  batched += chunkSize;
+                                  batches++;
+                                  return true;
+                              },
+                              batchOptions);
+    assert(batches == static_cast<int>((batched + 2) / 3));
+    int stoppedBatches = 0;
+    wm.EnumerateWindowBatches([&stoppedBatches](const WindowInfo *, size_t)
+                              {
+                                  stoppedBatches++;
+                                  return false;
+                              },
+                              batchOptions);
+    assert(stoppedBatches <= 1);
+    std::cout << "PASSED (" << batched << " windows in " << batches << " batches)\n";
+
+    // Test the multi-display manager on the default display
+    std::cout << "Test: MultiDisplayManager... ";
+    MultiDisplayManager displays;
+    int first = displays.AddDisplay("");
+    assert(first == 0);
+    assert(displays.GetDisplayCount() == 1);
+    auto merged = displays.GetAllWindows();
+    for (const auto &w : merged)
+    {
+        assert(w.id.display == first && w.id.handle == w.window.handle);
+    }
+    assert(displays.GetWindowInfo(DisplayHandle{5, NativeHandle{}}).error == ErrorCode::InvalidHandle);
+    displays.Shutdown();
+    assert(displays.GetDisplayCount() == 0);
+    std::cout << "PASSED (" << merged.size() << " windows)\n";
+
+    // Test adopting a connection: without a display there is nothing to adopt
+    std::cout << "Test: Initialize (external connection)... ";
+    WindowManager adopted;
+    assert(!adopted.Initialize(ExternalConnection{}));
+    assert(!adopted.IsInitialized());
+    assert(!adopted.ProcessEvent(nullptr));
+#if defined(CROSSWINDOW_LINUX) && defined(CROSSWINDOW_HAVE_X11_XCB)
+    // Borrowed: Shutdown leaves the host's connection open
+    if (Display *hostDisplay = XOpenDisplay(nullptr))
+    {
+        ExternalConnection borrowed;
+        borrowed.display = hostDisplay;
+        borrowed.xcbConnection = XGetXCBConnection(hostDisplay);
+        assert(adopted.Initialize(borrowed));
+        adopted.GetAllWindows();
+        adopted.Shutdown();
+        assert(!xcb_connection_has_error(XGetXCBConnection(hostDisplay)));
+        XSync(hostDisplay, False);
+        XCloseDisplay(hostDisplay);
+    }
+    // Owned, with the Display's own XCB connection: closed exactly once
+    if (Display *ownedDisplay = XOpenDisplay(nullptr))
+    {
+        ExternalConnection owned;
+        owned.display = ownedDisplay;
+        owned.xcbConnection = XGetXCBConnection(ownedDisplay);
+        owned.takeOwnership = true;
+        WindowManager owner;
+        assert(owner.Initialize(owned));
+        owner.GetAllWindows();
+        owner.Shutdown();
+        assert(!owner.IsInitialized());
+    }
+#endif
+    std::cout << "PASSED\n";
+
     // Print first 5 windows for debugging
     std::cout << "\nFirst 5 windows:\n";
     int shown = 0;
@@ -88,6 +642,8 @@ int main()
     std::cout << "\nTest: Shutdown... ";
     wm.Shutdown();
     assert(!wm.IsInitialized());
+    assert(!wm.IsConnected());
+    assert(wm.CloseWindow(NativeHandle{}) == ErrorCode::NotInitialized);
     std::cout << "PASSED\n";
 
     std::cout << "\n======================\n";